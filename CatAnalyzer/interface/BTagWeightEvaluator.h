@@ -28,6 +28,8 @@ public:
 
   // For per-jet SF evaluation - useful for CSV weight
   double getSF(const cat::Jet& jet, const int unc) const;
+  // Same as above, with the discriminator position resolved by cat::Jet::bDiscriminatorIndex
+  double getSF(const cat::Jet& jet, const int unc, const int discrIndex) const;
 
   enum CSVUNC {
     CENTRAL, JES_UP, JES_DN,
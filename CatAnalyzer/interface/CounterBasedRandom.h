@@ -0,0 +1,72 @@
+#ifndef CATTools_CatAnalyzer_CounterBasedRandom_H
+#define CATTools_CatAnalyzer_CounterBasedRandom_H
+
+#include <cstdint>
+
+namespace cat {
+
+// Counter based random number generator, Philox4x32-10 of Salmon et al. (SC11).
+// Random numbers are a pure function of the key and the counter, there is no state
+// carried from one trial to another. A trial of the kinematic reconstruction smearing
+// is fixed by (key, stream, trial) and gives the same numbers whatever the order
+// the trials or combinations are processed in, or the thread they are run on.
+class CounterBasedRandom
+{
+public:
+  CounterBasedRandom(const uint64_t key = 0, const uint32_t stream = 0) { setKey(key, stream); }
+
+  // key: typically the event number, stream: the object combination or run number
+  void setKey(const uint64_t key, const uint32_t stream = 0)
+  {
+    key_[0] = uint32_t(key);
+    key_[1] = uint32_t(key >> 32);
+    stream_ = stream;
+    setTrial(0);
+  }
+  // Restart the sequence for the given trial
+  void setTrial(const uint32_t trial)
+  {
+    counter_[0] = 0; counter_[1] = trial; counter_[2] = stream_; counter_[3] = 0;
+    index_ = 4;
+  }
+
+  // Uniform in (0,1), same 32bit resolution as TRandom3::Rndm()
+  double flat()
+  {
+    if ( index_ == 4 ) {
+      philox(counter_, key_, buffer_);
+      ++counter_[0];
+      index_ = 0;
+    }
+    return (buffer_[index_++] + 0.5) * (1./4294967296.);
+  }
+
+  static void philox(const uint32_t in[4], const uint32_t key[2], uint32_t out[4])
+  {
+    uint32_t c0 = in[0], c1 = in[1], c2 = in[2], c3 = in[3];
+    uint32_t k0 = key[0], k1 = key[1];
+    for ( int round = 0; round < 10; ++round ) {
+      if ( round > 0 ) { k0 += 0x9E3779B9; k1 += 0xBB67AE85; }
+      const uint64_t p0 = uint64_t(0xD2511F53) * c0;
+      const uint64_t p1 = uint64_t(0xCD9E8D57) * c2;
+      const uint32_t hi0 = p0 >> 32, lo0 = uint32_t(p0);
+      const uint32_t hi1 = p1 >> 32, lo1 = uint32_t(p1);
+      c0 = hi1 ^ c1 ^ k0;
+      c1 = lo1;
+      c2 = hi0 ^ c3 ^ k1;
+      c3 = lo0;
+    }
+    out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
+  }
+
+private:
+  uint32_t key_[2];
+  uint32_t stream_;
+  uint32_t counter_[4];
+  uint32_t buffer_[4];
+  int index_;
+};
+
+}
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef CATTools_CatAnalyzer_KinRecoInputs_H
+#define CATTools_CatAnalyzer_KinRecoInputs_H
+
+#include "TH1.h"
+
+#include <memory>
+#include <string>
+
+namespace cat {
+
+// Resolution and weight histograms of the DESY kinematic reconstruction.
+// One copy per input file is shared by all KinematicReconstruction and
+// DESYSmearedSolver instances of the process, it is released with its last user.
+// The histograms are read-only after loading, their cumulative integrals are
+// already computed so that GetIntegral() does not modify them.
+class KinRecoInputs
+{
+public:
+  // Inputs of the file at fullPath, loaded at the first call
+  static std::shared_ptr<const KinRecoInputs> get(const std::string& fullPath);
+
+  KinRecoInputs(const KinRecoInputs&) = delete;
+  KinRecoInputs& operator=(const KinRecoInputs&) = delete;
+
+  TH1* jetEres() const { return h_jetEres_.get(); }
+  TH1* jetAres() const { return h_jetAres_.get(); }
+  TH1* lepEres() const { return h_lepEres_.get(); }
+  TH1* lepAres() const { return h_lepAres_.get(); }
+  TH1* wmass() const { return h_wmass_.get(); }
+  TH1* mbl_w() const { return h_mbl_w_.get(); }
+
+private:
+  KinRecoInputs(const std::string& fullPath);
+
+  std::unique_ptr<TH1> h_jetEres_, h_jetAres_;
+  std::unique_ptr<TH1> h_lepEres_, h_lepAres_;
+  std::unique_ptr<TH1> h_wmass_;
+  std::unique_ptr<TH1> h_mbl_w_;
+};
+
+}
+
+#endif
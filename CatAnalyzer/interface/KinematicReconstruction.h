@@ -3,11 +3,14 @@
 
 #include <vector>
 #include <map>
+#include <memory>
+#include <functional>
 
 #include <TLorentzVector.h>
 
 class TH1;
 class TRandom3;
+namespace cat { class CounterBasedRandom; class KinRecoInputs; }
 
 #include "classes.h"
 #include "sampleHelpers.h"
@@ -35,9 +38,13 @@ class KinematicReconstruction{
     
 public:
     
-    KinematicReconstruction(const int minNumberOfBtags, const bool preferBtags, const bool massLoop =false);
+    KinematicReconstruction(const int minNumberOfBtags, const bool preferBtags, const bool massLoop =false, const bool parallel =false,
+                            const bool counterBasedRandom =false);
     ~KinematicReconstruction(){}
     
+    /// Key of the counter based random numbers, to be set for each event if counterBasedRandom is enabled
+    void setRandomKey(const unsigned long long key){randomKey_ = key;}
+    
     int getNSol()const;
     Struct_KinematicReconstruction getSol()const;
     std::vector<Struct_KinematicReconstruction> getSols()const;
@@ -56,6 +63,23 @@ public:
     
 private:
     
+    /// Lepton, antilepton and pair of jets entering one solution
+    struct ObjectCombination{
+        int leptonIndex, antiLeptonIndex;
+        int jetIndex1, jetIndex2;
+    };
+    
+    /// Add solutions of all combinations to result, in the order of the combinations
+    void addSolutionsPerObjectCombinations(KinematicReconstructionSolutions& result,
+                                           const std::vector<ObjectCombination>& combinations,
+                                           const VLV& allLeptons,
+                                           const VLV& allJets, const std::vector<double>& btags,
+                                           const LV& met,
+                                           const int numberOfBtags)const;
+    
+    /// Call function for indices 0..n-1, distributed over TBB worker threads in parallel mode
+    void forEachCombination(const size_t n, const std::function<void(const size_t)>& function)const;
+    
     /// Calculate solution for specific lepton, antilepton and pair of jets
     std::vector<KinematicReconstructionSolution> solutionsPerObjectCombination(const int leptonIndex, const int antiLeptonIndex,
                                                                                const int jetIndex1, const int jetIndex2,
@@ -64,8 +88,11 @@ private:
                                                                                const LV& met,
                                                                                const int numberOfBtags)const;
     
-    /// Set seeds for random number generators
-    void setRandomNumberSeeds(const LV& lepton, const LV& antiLepton, const LV& jet1, const LV& jet2)const;
+    /// Seed of the random numbers for the smearing of a combination, depends only on its kinematics
+    unsigned int randomNumberSeed(const LV& lepton, const LV& antiLepton, const LV& jet1, const LV& jet2)const;
+    
+    /// Random number following the distribution of the histogram, TH1::GetRandom() unless a counter based generator is given
+    double getRandom(TH1* h, cat::CounterBasedRandom* rng)const;
     
     /// Minimum number of b-tags required for solutions (0, 1, 2)
     const int minNumberOfBtags_;
@@ -76,6 +103,13 @@ private:
     /// Whether to run mass loop for top mass, instead of smearings according to uncertainties
     const bool massLoop_;
     
+    /// Whether to evaluate the object combinations of an event in parallel, results are identical to the serial evaluation
+    const bool parallel_;
+    
+    /// Whether to draw the smearing from the counter based generator keyed by the event, instead of reseeding gRandom
+    const bool counterBasedRandom_;
+    unsigned long long randomKey_;
+    
     
     
     // FIXME: temporary helper variables for cleanup
@@ -92,7 +126,7 @@ private:
     
     
     
-    void angle_rot(const double& alpha, const double& e, const TLorentzVector& inJet, TLorentzVector& jet_sm)const;
+    void angle_rot(const double& alpha, const double& e, const TLorentzVector& inJet, TLorentzVector& jet_sm, cat::CounterBasedRandom* rng)const;
     
     TRandom3* r3_;
     
@@ -100,6 +134,9 @@ private:
     Struct_KinematicReconstruction sol_;
     std::vector<Struct_KinematicReconstruction> sols_;
     
+    // Input histograms, shared between instances
+    std::shared_ptr<const cat::KinRecoInputs> inputs_;
+    
     // W mass
     TH1* h_wmass_;
 
@@ -20,8 +20,10 @@ public:
     void add(const TLorentzVector& top, const TLorentzVector& topbar, const TLorentzVector& n, const TLorentzVector& nbar, const double& weight, const double& mbl_weight);
     void add(const TLorentzVector& top, const TLorentzVector& topbar, const TLorentzVector& n, const TLorentzVector& nbar, const double& weight);
     
-    void getMeanVect(TLorentzVector& lv, const std::vector<TLorentzVector>& vlv, const double& mass)const;
     void getMeanSol(TLorentzVector& top, TLorentzVector& topbar, TLorentzVector& n, TLorentzVector& nbar)const;
+    /// Solution with the highest single weight, the first one in case of equal weights
+    void getMaxSol(TLorentzVector& top, TLorentzVector& topbar, TLorentzVector& n, TLorentzVector& nbar)const;
+    double getMaxWeight()const;
     double getSumWeight()const;
     int getNsol()const;
     void clear();
@@ -35,15 +37,30 @@ public:
     
 private:
     
-    std::vector<TLorentzVector> v_top_;
-    std::vector<TLorentzVector> v_topbar_;
-    std::vector<TLorentzVector> v_n_;
-    std::vector<TLorentzVector> v_nbar_;
+    /// Running weighted sums of the momentum components, solutions are not stored
+    struct WeightedSum{
+        double px, py, pz;
+        void add(const TLorentzVector& lv, const double& weight);
+        void clear(){px = py = pz = 0;}
+    };
     
-    std::vector<double> v_weight_;
+    void getMeanVect(TLorentzVector& lv, const WeightedSum& sum, const double& mass)const;
+    
+    WeightedSum sum_top_;
+    WeightedSum sum_topbar_;
+    WeightedSum sum_n_;
+    WeightedSum sum_nbar_;
+    
+    int nsol_;
     double sum_weight_;  
     double max_sum_weight_;
     
+    double max_weight_;
+    TLorentzVector max_top_;
+    TLorentzVector max_topbar_;
+    TLorentzVector max_n_;
+    TLorentzVector max_nbar_;
+    
     const double mass_top_;
 };
 
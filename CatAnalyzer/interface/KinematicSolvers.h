@@ -5,6 +5,8 @@
 #include "FWCore/ParameterSet/interface/ParameterSet.h"
 #include "CLHEP/Random/RandomEngine.h"
 #include "Math/LorentzVector.h"
+#include "CATTools/CatAnalyzer/interface/CounterBasedRandom.h"
+#include "CATTools/CatAnalyzer/interface/KinRecoInputs.h"
 #include <string>
 #include <memory>
 #include "TH1.h"
@@ -152,16 +154,23 @@ public:
   void solve(const LV input[]) override;
   std::string algoName() override { return "DESYSmeared"; }
   void setRandom(CLHEP::HepRandomEngine* rng) { rng_ = rng; }
+  // Key of the counter based random numbers, to be set for each event if counterBasedRandom is enabled
+  void setRandomKey(const unsigned long long key) { randomKey_ = key; }
 
 protected:
   LV getSmearedLV(const LV& v, const double fE, const double dRot);
   double getRandom(TH1* h);
+  double flat() { return useCounterBasedRandom_ ? counterRng_.flat() : rng_->flat(); }
 
   CLHEP::HepRandomEngine* rng_;
-  std::unique_ptr<TH1> h_jetEres_, h_jetAres_;
-  std::unique_ptr<TH1> h_lepEres_, h_lepAres_;
-  std::unique_ptr<TH1> h_wmass_;
-  std::unique_ptr<TH1> h_mbl_w_;
+  const bool useCounterBasedRandom_;
+  unsigned long long randomKey_;
+  CounterBasedRandom counterRng_;
+  std::shared_ptr<const KinRecoInputs> inputs_;
+  TH1* h_jetEres_, * h_jetAres_;
+  TH1* h_lepEres_, * h_lepAres_;
+  TH1* h_wmass_;
+  TH1* h_mbl_w_;
 
   const int nTrial_;
   const double maxLBMass_, mTopInput_;
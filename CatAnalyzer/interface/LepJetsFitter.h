@@ -17,7 +17,13 @@ namespace cat {
 namespace ttbb{
 
   double SolvettbarLepJets(double &nupz, Double_t &metscale, Double_t &blscale, Double_t &bjscale, Double_t &j1scale, Double_t &j2scale);
-  void   FindHadronicTop        (TLorentzVector &lepton, std::vector<cat::ComJet> &jets, TLorentzVector &met, bool usebtaginfo, bool useCSVOrderinfo, std::vector<int> &bestindices, float &bestchi2, TLorentzVector &nusol, TLorentzVector &blrefit, TLorentzVector &bjrefit, TLorentzVector &j1refit, TLorentzVector &j2refit);
+  // Same fit with a Levenberg-Marquardt minimisation seeded from the W mass, MIGRAD is used if it does not converge
+  double SolvettbarLepJetsGN(double &nupz, Double_t &metscale, Double_t &blscale, Double_t &bjscale, Double_t &j1scale, Double_t &j2scale);
+  void   FindHadronicTop        (TLorentzVector &lepton, std::vector<cat::ComJet> &jets, TLorentzVector &met, bool usebtaginfo, bool useCSVOrderinfo, std::vector<int> &bestindices, float &bestchi2, TLorentzVector &nusol, TLorentzVector &blrefit, TLorentzVector &bjrefit, TLorentzVector &j1refit, TLorentzVector &j2refit, bool useGaussNewton = false);
+
+  // Lower bound of the fcnfull chi2 for a choice of hadronic b and W jets, used to skip permutations
+  // with the jet energy resolutions bjres, j1res, j2res of the fit
+  double HadronicChi2LowerBound(const TLorentzVector &bj, const TLorentzVector &j1, const TLorentzVector &j2, float bjres, float j1res, float j2res);
 
   void fcnfull(Int_t &npar, Double_t *gin, Double_t &f, Double_t *par, Int_t iflag);
 
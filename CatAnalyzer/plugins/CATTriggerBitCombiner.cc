@@ -14,6 +14,7 @@ class CATTriggerBitCombiner : public edm::stream::EDFilter<>
 public:
   CATTriggerBitCombiner(const edm::ParameterSet& pset);
   bool filter(edm::Event& event, const edm::EventSetup&) override;
+  void beginLuminosityBlock(const edm::LuminosityBlock& lumi, const edm::EventSetup&) override;
 
 private:
   //typedef std::vector<bool> vbool;
@@ -25,6 +26,11 @@ private:
   strings triggersToMatch_;
   bool combineByOr_;
 
+  // Trigger names of the current lumi and the indices of the paths matching
+  // triggersToMatch_, one entry per (path, pattern) match.
+  // Rebuilt only when the names change between lumi blocks
+  strings cachedTrigNames_;
+  std::vector<int> matchedIndices_;
 };
 
 CATTriggerBitCombiner::CATTriggerBitCombiner(const edm::ParameterSet& pset):
@@ -42,20 +48,36 @@ CATTriggerBitCombiner::CATTriggerBitCombiner(const edm::ParameterSet& pset):
   produces<int>();
 }
 
+void CATTriggerBitCombiner::beginLuminosityBlock(const edm::LuminosityBlock& lumi, const edm::EventSetup&)
+{
+  edm::Handle<cat::TriggerNames> trigNamesHandle;
+  lumi.getByToken(trigNamesToken_, trigNamesHandle);
+
+  const auto& trigNames = trigNamesHandle->names();
+  if ( trigNames == cachedTrigNames_ ) return;
+  cachedTrigNames_ = trigNames;
+
+  matchedIndices_.clear();
+  for ( int index=0, nTrig=trigNames.size(); index<nTrig; ++index ) {
+    const auto& trigName = trigNames[index];
+    for ( const auto& trigPattern : triggersToMatch_ ) {
+      if ( trigName.find(trigPattern) != 0 ) continue;
+      matchedIndices_.push_back(index);
+    }
+  }
+}
+
 bool CATTriggerBitCombiner::filter(edm::Event& event, const edm::EventSetup&)
 {
   using namespace std;
 
-  edm::Handle<cat::TriggerNames> trigNamesHandle;
-  event.getLuminosityBlock().getByToken(trigNamesToken_, trigNamesHandle);
-
   edm::Handle<cat::TriggerBits> trigBitsHandle;
   event.getByToken(trigBitsToken_, trigBitsHandle);
 
-  if ( trigNamesHandle->names().size() != trigBitsHandle->values().size() ) {
+  if ( cachedTrigNames_.size() != trigBitsHandle->size() ) {
     std::cout << "Inconsistent number of trig bits\n";
-    std::cout << "From names = " << trigNamesHandle->names().size() << '\n';
-    std::cout << "From bits  = " << trigBitsHandle->values().size() << '\n';
+    std::cout << "From names = " << cachedTrigNames_.size() << '\n';
+    std::cout << "From bits  = " << trigBitsHandle->size() << '\n';
     event.put(std::auto_ptr<int>(new int(0)));
     return false;
   }
@@ -63,15 +85,10 @@ bool CATTriggerBitCombiner::filter(edm::Event& event, const edm::EventSetup&)
   // Keep trigger indices and ps factors
   std::vector<int> results;
   bool hasFailed = false;
-  const auto trigNames = trigNamesHandle->names();
-  for ( int index=0, nTrig=trigNames.size(); index<nTrig; ++index ) {
-    const auto& trigName = trigNames[index];
+  for ( const int index : matchedIndices_ ) {
     const int accPS = trigBitsHandle->result(index);
-    for ( const auto& trigPattern : triggersToMatch_ ) {
-      if ( trigName.find(trigPattern) != 0 ) continue;
-      if ( accPS == 0 ) hasFailed = true;
-      else results.push_back(accPS);
-    }
+    if ( accPS == 0 ) hasFailed = true;
+    else results.push_back(accPS);
   }
 
   int result = 0;
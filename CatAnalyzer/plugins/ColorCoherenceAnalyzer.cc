@@ -47,6 +47,7 @@ private:
   edm::EDGetTokenT<int>   vtxToken_;
   edm::EDGetTokenT<edm::TriggerResults> triggerBits_;
   edm::EDGetTokenT<pat::TriggerObjectStandAloneCollection> triggerObjects_;
+  cat::TriggerPathIndex trigPathIndex_;
   edm::EDGetTokenT<float> pileupWeight_;
   edm::EDGetTokenT<float> pileupWeight_up_;
   edm::EDGetTokenT<float> pileupWeight_dn_;
@@ -169,7 +170,7 @@ void ColorCoherenceAnalyzer::analyze(const edm::Event& iEvent, const edm::EventS
   iEvent.getByToken(triggerObjects_, triggerObjects);
 
   const edm::TriggerNames &triggerNames = iEvent.triggerNames(*triggerBits);
-  cat::AnalysisHelper trigHelper = cat::AnalysisHelper(triggerNames, triggerBits, triggerObjects);
+  cat::AnalysisHelper trigHelper = cat::AnalysisHelper(triggerNames, triggerBits, triggerObjects, trigPathIndex_);
 
   edm::Handle<float> pileupWeight;
   edm::Handle<float> pileupWeight_up;
@@ -92,6 +92,11 @@ void TTLLKinSolutionProducer::beginLuminosityBlock(const edm::LuminosityBlock& l
 
 void TTLLKinSolutionProducer::produce(edm::Event& event, const edm::EventSetup&)
 {
+  if ( dynamic_cast<DESYSmearedSolver*>(solver_.get()) != 0 ) {
+    const unsigned long long key = (static_cast<unsigned long long>(event.id().run()) << 32) ^ event.id().event();
+    dynamic_cast<DESYSmearedSolver*>(solver_.get())->setRandomKey(key);
+  }
+
   std::auto_ptr<CandColl> cands(new CandColl);
   //auto candsRefProd = event.getRefBeforePut<CRCandColl>();
 
@@ -70,6 +70,7 @@ private:
   edm::EDGetTokenT<cat::GenWeights>                genWeightToken_;
   edm::EDGetTokenT<edm::TriggerResults>            triggerBits_;
   edm::EDGetTokenT<pat::TriggerObjectStandAloneCollection> triggerObjects_;
+  cat::TriggerPathIndex trigPathIndex_;
 
   // ---------- CSV weight ------------
   BTagWeightEvaluator csvWeight;
@@ -277,7 +278,7 @@ void TopAnalyzer::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetu
   iEvent.getByToken(triggerBits_, triggerBits);
   iEvent.getByToken(triggerObjects_, triggerObjects);
   const edm::TriggerNames &triggerNames = iEvent.triggerNames(*triggerBits);
-  AnalysisHelper trigHelper = AnalysisHelper(triggerNames, triggerBits, triggerObjects);
+  AnalysisHelper trigHelper = AnalysisHelper(triggerNames, triggerBits, triggerObjects, trigPathIndex_);
   //we don't use triggerObjects here: can be removed. 
 
   bool PassMuonTrigger = (trigHelper.triggerFired("HLT_IsoMu24_v") || trigHelper.triggerFired("HLT_IsoTkMu24_v"));
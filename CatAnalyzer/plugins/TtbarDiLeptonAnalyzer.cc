@@ -37,6 +37,11 @@
 #include "CATTools/DataFormats/interface/SecVertex.h"
 #include<TClonesArray.h>
 
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <tuple>
+
 using namespace std;
 using namespace cat;
 
@@ -51,8 +56,13 @@ private:
   virtual void analyze(const edm::Event&, const edm::EventSetup&) override;
   void beginLuminosityBlock(const edm::LuminosityBlock& lumi, const edm::EventSetup&) override;
   void endLuminosityBlock(const edm::LuminosityBlock&, const edm::EventSetup&) override {};
+  void endJob() override;
 
   void setBranch(TTree* tree, systematic sys);
+  void branchP4(TTree* tree, const std::string& name, TLorentzVector* p4);
+  void fillFlatP4();
+  void analyzeWithFriendTrees(const edm::Event& iEvent);
+  int charmDaughterIndex(const reco::Candidate& dau);
   void resetBranch();
   bool genInformation(const edm::Event& iEvent);
   bool eventSelection(const edm::Event& iEvent, systematic sys);
@@ -128,10 +138,36 @@ private:
   float b_desyttbar_dphi;
   float b_desyjet1_CSVInclV2, b_desyjet2_CSVInclV2;
 
+  // Four-vectors written as float pt, eta, phi, m leaves instead of TLorentzVector objects
+  struct FlatP4 {
+    const TLorentzVector* p4;
+    int mantissaBits;
+    float pt, eta, phi, m;
+  };
+  bool useFlatP4_;
+  std::map<std::string, int> flatP4Bits_; // mantissa bits kept per branch, "mantissaBits" for the default
+  std::map<std::string, FlatP4> flatP4s_;
+
+  // Branches changing with the object variations. With the friend tree layout the variation trees
+  // keep only these and the run, event index, the rest is read from the nominal tree
+  struct SystBranches {
+    int step, channel, njet, nbjet, lep1_pid, lep2_pid, is3lep;
+    bool step1, step2, step3, step4, step5, step6, step7;
+    float tri, tri_up, tri_dn, met, mueffweight, eleffweight, btagweight;
+    float jet1_CSVInclV2, jet2_CSVInclV2, ttbar_dphi;
+    float desyjet1_CSVInclV2, desyjet2_CSVInclV2, desyttbar_dphi;
+    TLorentzVector lep1, lep2, dilep, jet1, jet2, top1, top2, ttbar;
+    TLorentzVector desyjet1, desyjet2, desytop1, desytop2, desyttbar;
+    std::vector<float> csvweights;
+  };
+  void swapSystBranches(SystBranches& x);
+  bool useFriendTrees_;
+  std::vector<SystBranches> systBranches_;
+
   //std::unique_ptr<TtFullLepKinSolver> solver;
   std::unique_ptr<KinematicSolver> solver_;
 
-  const KinematicReconstruction* kinematicReconstruction;
+  KinematicReconstruction* kinematicReconstruction;
   typedef math::XYZTLorentzVector LV;
   typedef std::vector<LV> VLV;
 
@@ -181,6 +217,22 @@ private:
   TClonesArray *b_dstar, *b_dstar_dau1, *b_dstar_dau2, *b_dstar_dau3;
   TClonesArray *b_Jpsi,    *b_Jpsi_dau1,    *b_Jpsi_dau2;
 
+  // Charm candidates as float arrays instead of the TClonesArrays,
+  // daughters are stored once in a table shared by all candidates and referred by index
+  struct P4Array {
+    std::vector<float> pt, eta, phi, m;
+    void branch(TTree* tr, const std::string& name);
+    void push_back(const TLorentzVector& p4);
+    void clear() { pt.clear(); eta.clear(); phi.clear(); m.clear(); }
+  };
+  bool useFlatCharm_;
+  P4Array b_d0_p4, b_dstar_p4, b_Jpsi_p4, b_charmDau_p4;
+  std::vector<float> b_charmDau_q;
+  std::vector<int> b_d0_dau1_idx, b_d0_dau2_idx;
+  std::vector<int> b_dstar_dau1_idx, b_dstar_dau2_idx, b_dstar_dau3_idx;
+  std::vector<int> b_Jpsi_dau1_idx, b_Jpsi_dau2_idx;
+  std::map<std::tuple<float, float, float, int>, int> charmDauIdx_; // same track in several candidates
+
   edm::EDGetTokenT<cat::SecVertexCollection>      d0Token_;
   edm::EDGetTokenT<cat::SecVertexCollection>      dstarToken_;
   edm::EDGetTokenT<cat::SecVertexCollection>      JpsiToken_;
@@ -201,6 +253,10 @@ TtbarDiLeptonAnalyzer::TtbarDiLeptonAnalyzer(const edm::ParameterSet& iConfig)
   JpsiToken_  = consumes<cat::SecVertexCollection>(iConfig.getParameter<edm::InputTag>("Jpsis"));
   mcSrc_ = consumes<edm::View<reco::GenParticle> >(iConfig.getParameter<edm::InputTag>("mcLabel"));
   matchingDeltaR_  = iConfig.getParameter<double>("matchingDeltaR");
+  useFlatCharm_ = iConfig.existsAs<bool>("flatCharmCandidates") and iConfig.getParameter<bool>("flatCharmCandidates");
+  b_d0 = b_d0_dau1 = b_d0_dau2 = nullptr;
+  b_dstar = b_dstar_dau1 = b_dstar_dau2 = b_dstar_dau3 = nullptr;
+  b_Jpsi = b_Jpsi_dau1 = b_Jpsi_dau2 = nullptr;
 
   // ############## Dstar end #####################
   recoFiltersToken_ = consumes<int>(iConfig.getParameter<edm::InputTag>("recoFilters"));
@@ -264,6 +320,17 @@ TtbarDiLeptonAnalyzer::TtbarDiLeptonAnalyzer(const edm::ParameterSet& iConfig)
     solver_.reset(new TTDileptonSolver(solverPSet)); // A dummy solver
   }
 
+  useFlatP4_ = iConfig.existsAs<edm::ParameterSet>("flatP4");
+  if ( useFlatP4_ ) {
+    const auto flatP4Set = iConfig.getParameter<edm::ParameterSet>("flatP4");
+    for ( auto& name : flatP4Set.getParameterNamesForType<int>() ) {
+      flatP4Bits_[name] = std::max(0, std::min(23, flatP4Set.getParameter<int>(name)));
+    }
+  }
+
+  useFriendTrees_ = iConfig.existsAs<bool>("friendSystematicTrees") and iConfig.getParameter<bool>("friendSystematicTrees");
+  systBranches_.resize(syst_total);
+
   csvWeight.initCSVWeight(false, "csvv2");
   bTagWeightL.init(3, "csvv2", BTagEntry::OP_LOOSE , 1);
   bTagWeightM.init(3, "csvv2", BTagEntry::OP_MEDIUM, 1);
@@ -280,7 +347,9 @@ TtbarDiLeptonAnalyzer::TtbarDiLeptonAnalyzer(const edm::ParameterSet& iConfig)
   
   for (int i = 0; i < NCutflow; i++) cutflow_.push_back({0,0,0,0});
 
-  kinematicReconstruction = new KinematicReconstruction(1, true);
+  const bool kinRecoParallel = iConfig.existsAs<bool>("kinRecoParallel") and iConfig.getParameter<bool>("kinRecoParallel");
+  const bool kinRecoCounterBasedRandom = iConfig.existsAs<bool>("kinRecoCounterBasedRandom") and iConfig.getParameter<bool>("kinRecoCounterBasedRandom");
+  kinematicReconstruction = new KinematicReconstruction(1, true, false, kinRecoParallel, kinRecoCounterBasedRandom);
 
 }
 
@@ -297,6 +366,16 @@ TtbarDiLeptonAnalyzer::~TtbarDiLeptonAnalyzer()
 }
 
 
+void TtbarDiLeptonAnalyzer::endJob()
+{
+  // Index for the friend tree layout, stored with the trees. A variation tree with the nominal tree
+  // as its friend reads the unchanged branches from the nominal entry with the same run, event.
+  if (!useFriendTrees_) return;
+  for (auto tr : ttree_) {
+    if (tr->GetEntries() > 0) tr->BuildIndex("run", "event");
+  }
+}
+
 // #####################  Dstar begin  ########################
 
 int TtbarDiLeptonAnalyzer::isFromtop( const reco::GenParticle& p){
@@ -351,6 +430,15 @@ void TtbarDiLeptonAnalyzer::beginLuminosityBlock(const edm::LuminosityBlock& lum
 void TtbarDiLeptonAnalyzer::analyze(const edm::Event& iEvent, const edm::EventSetup& iSetup)
 {
   runOnMC = !iEvent.isRealData();
+  const unsigned long long randomKey = (static_cast<unsigned long long>(iEvent.id().run()) << 32) ^ iEvent.id().event();
+  kinematicReconstruction->setRandomKey(randomKey);
+  if ( dynamic_cast<DESYSmearedSolver*>(solver_.get()) != 0 ) {
+    dynamic_cast<DESYSmearedSolver*>(solver_.get())->setRandomKey(randomKey);
+  }
+  if (runOnMC && useFriendTrees_) {
+    analyzeWithFriendTrees(iEvent);
+    return;
+  }
 
   bool keepGenSignal = false;
   bool keepEvent = false;
@@ -364,12 +452,69 @@ void TtbarDiLeptonAnalyzer::analyze(const edm::Event& iEvent, const edm::EventSe
     
     keepEvent = eventSelection(iEvent, systematic(sys));
     
-    if (keepGenSignal || keepEvent)
+    if (keepGenSignal || keepEvent) {
+      if (useFlatP4_) fillFlatP4();
       ttree_[sys]->Fill();
+    }
   
   }
 }
 
+void TtbarDiLeptonAnalyzer::analyzeWithFriendTrees(const edm::Event& iEvent)
+{
+  // Each variation tree gets the same events as in the full copy layout and is attached to the
+  // nominal tree with the run, event index. The nominal tree also keeps the events selected only
+  // by a variation (with step -1), so that their unchanged branches can be found through the index.
+  // The variations are done first and put aside, eventSelection of a variation overwrites
+  // some of the nominal only branches and they are reset before the nominal.
+  bool keepEvent[syst_total];
+  bool keepAnyVariation = false;
+  for (int sys = 1; sys < syst_total; ++sys){
+    resetBranch();
+    keepEvent[sys] = eventSelection(iEvent, systematic(sys));
+    keepAnyVariation |= keepEvent[sys];
+    swapSystBranches(systBranches_[sys]);
+  }
+
+  resetBranch();
+  const bool keepGenSignal = genInformation(iEvent);
+  keepEvent[syst_nom] = eventSelection(iEvent, syst_nom);
+  if (!keepGenSignal && !keepEvent[syst_nom] && !keepAnyVariation) return;
+
+  if (useFlatP4_) fillFlatP4();
+  ttree_[syst_nom]->Fill();
+
+  for (int sys = 1; sys < syst_total; ++sys){
+    swapSystBranches(systBranches_[sys]);
+    if (!keepGenSignal && !keepEvent[sys]) continue;
+    if (useFlatP4_) fillFlatP4();
+    ttree_[sys]->Fill();
+  }
+}
+
+void TtbarDiLeptonAnalyzer::swapSystBranches(SystBranches& x)
+{
+  std::swap(b_step, x.step); std::swap(b_channel, x.channel);
+  std::swap(b_njet, x.njet); std::swap(b_nbjet, x.nbjet);
+  std::swap(b_lep1_pid, x.lep1_pid); std::swap(b_lep2_pid, x.lep2_pid);
+  std::swap(b_is3lep, x.is3lep);
+  std::swap(b_step1, x.step1); std::swap(b_step2, x.step2); std::swap(b_step3, x.step3); std::swap(b_step4, x.step4);
+  std::swap(b_step5, x.step5); std::swap(b_step6, x.step6); std::swap(b_step7, x.step7);
+  std::swap(b_tri, x.tri); std::swap(b_tri_up, x.tri_up); std::swap(b_tri_dn, x.tri_dn);
+  std::swap(b_met, x.met);
+  std::swap(b_mueffweight, x.mueffweight); std::swap(b_eleffweight, x.eleffweight); std::swap(b_btagweight, x.btagweight);
+  std::swap(b_jet1_CSVInclV2, x.jet1_CSVInclV2); std::swap(b_jet2_CSVInclV2, x.jet2_CSVInclV2);
+  std::swap(b_ttbar_dphi, x.ttbar_dphi);
+  std::swap(b_desyjet1_CSVInclV2, x.desyjet1_CSVInclV2); std::swap(b_desyjet2_CSVInclV2, x.desyjet2_CSVInclV2);
+  std::swap(b_desyttbar_dphi, x.desyttbar_dphi);
+  std::swap(b_lep1, x.lep1); std::swap(b_lep2, x.lep2); std::swap(b_dilep, x.dilep);
+  std::swap(b_jet1, x.jet1); std::swap(b_jet2, x.jet2);
+  std::swap(b_top1, x.top1); std::swap(b_top2, x.top2); std::swap(b_ttbar, x.ttbar);
+  std::swap(b_desyjet1, x.desyjet1); std::swap(b_desyjet2, x.desyjet2);
+  std::swap(b_desytop1, x.desytop1); std::swap(b_desytop2, x.desytop2); std::swap(b_desyttbar, x.desyttbar);
+  b_csvweights.swap(x.csvweights);
+}
+
 bool TtbarDiLeptonAnalyzer::eventSelection(const edm::Event& iEvent, systematic sys)
 {
   if (sys == syst_nom) cutflow_[0][0]++;
@@ -470,19 +615,6 @@ bool TtbarDiLeptonAnalyzer::eventSelection(const edm::Event& iEvent, systematic
   int dstar_count=-1;
   int Jpsi_count=-1;
 
-  TClonesArray& br_d0 = *b_d0;
-  TClonesArray& br_d0_dau1 = *b_d0_dau1;
-  TClonesArray& br_d0_dau2 = *b_d0_dau2;
-
-  TClonesArray& br_dstar = *b_dstar;
-  TClonesArray& br_dstar_dau1 = *b_dstar_dau1;
-  TClonesArray& br_dstar_dau2 = *b_dstar_dau2;
-  TClonesArray& br_dstar_dau3 = *b_dstar_dau3;
-
-  TClonesArray& br_Jpsi = *b_Jpsi;
-  TClonesArray& br_Jpsi_dau1 = *b_Jpsi_dau1;
-  TClonesArray& br_Jpsi_dau2 = *b_Jpsi_dau2;
-
   TLorentzVector vecDMMom, vecDau12;
   float fQDau, fQDM;
 
@@ -496,9 +628,16 @@ bool TtbarDiLeptonAnalyzer::eventSelection(const edm::Event& iEvent, systematic
     d0_count++;
 
     auto d0_tlv = ToTLorentzVector(x);
-    new( br_d0[d0_count]) TLorentzVector(d0_tlv);
-    new( br_d0_dau1[d0_count]) TLorentzVector(ToTLorentzVector(*(x.daughter(0))));
-    new( br_d0_dau2[d0_count]) TLorentzVector(ToTLorentzVector(*(x.daughter(1))));
+    if ( useFlatCharm_ ) {
+      b_d0_p4.push_back(d0_tlv);
+      b_d0_dau1_idx.push_back(charmDaughterIndex(*(x.daughter(0))));
+      b_d0_dau2_idx.push_back(charmDaughterIndex(*(x.daughter(1))));
+    }
+    else {
+      new( (*b_d0)[d0_count]) TLorentzVector(d0_tlv);
+      new( (*b_d0_dau1)[d0_count]) TLorentzVector(ToTLorentzVector(*(x.daughter(0))));
+      new( (*b_d0_dau2)[d0_count]) TLorentzVector(ToTLorentzVector(*(x.daughter(1))));
+    }
 
     b_d0_dca.push_back( x.dca());
     double d0_vProb = x.vProb();
@@ -564,10 +703,18 @@ bool TtbarDiLeptonAnalyzer::eventSelection(const edm::Event& iEvent, systematic
     dstar_count++;
 
     auto dstar_tlv = ToTLorentzVector(x);
-    new( br_dstar[dstar_count]) TLorentzVector( dstar_tlv );
-    new( br_dstar_dau1[dstar_count]) TLorentzVector(ToTLorentzVector(*(x.daughter(0))));
-    new( br_dstar_dau2[dstar_count]) TLorentzVector(ToTLorentzVector(*(x.daughter(1))));
-    new( br_dstar_dau3[dstar_count]) TLorentzVector(ToTLorentzVector(*(x.daughter(2))));
+    if ( useFlatCharm_ ) {
+      b_dstar_p4.push_back(dstar_tlv);
+      b_dstar_dau1_idx.push_back(charmDaughterIndex(*(x.daughter(0))));
+      b_dstar_dau2_idx.push_back(charmDaughterIndex(*(x.daughter(1))));
+      b_dstar_dau3_idx.push_back(charmDaughterIndex(*(x.daughter(2))));
+    }
+    else {
+      new( (*b_dstar)[dstar_count]) TLorentzVector( dstar_tlv );
+      new( (*b_dstar_dau1)[dstar_count]) TLorentzVector(ToTLorentzVector(*(x.daughter(0))));
+      new( (*b_dstar_dau2)[dstar_count]) TLorentzVector(ToTLorentzVector(*(x.daughter(1))));
+      new( (*b_dstar_dau3)[dstar_count]) TLorentzVector(ToTLorentzVector(*(x.daughter(2))));
+    }
 
     b_dstar_dca.push_back( x.dca());
     b_dstar_dca2.push_back( x.dca(1));
@@ -643,9 +790,16 @@ bool TtbarDiLeptonAnalyzer::eventSelection(const edm::Event& iEvent, systematic
     Jpsi_count++;
 
     auto Jpsi_tlv = ToTLorentzVector(x);
-    new( br_Jpsi[Jpsi_count]) TLorentzVector( Jpsi_tlv );
-    new( br_Jpsi_dau1[Jpsi_count]) TLorentzVector(ToTLorentzVector(*(x.daughter(0))));
-    new( br_Jpsi_dau2[Jpsi_count]) TLorentzVector(ToTLorentzVector(*(x.daughter(1))));
+    if ( useFlatCharm_ ) {
+      b_Jpsi_p4.push_back(Jpsi_tlv);
+      b_Jpsi_dau1_idx.push_back(charmDaughterIndex(*(x.daughter(0))));
+      b_Jpsi_dau2_idx.push_back(charmDaughterIndex(*(x.daughter(1))));
+    }
+    else {
+      new( (*b_Jpsi)[Jpsi_count]) TLorentzVector( Jpsi_tlv );
+      new( (*b_Jpsi_dau1)[Jpsi_count]) TLorentzVector(ToTLorentzVector(*(x.daughter(0))));
+      new( (*b_Jpsi_dau2)[Jpsi_count]) TLorentzVector(ToTLorentzVector(*(x.daughter(1))));
+    }
 
     b_Jpsi_dca.push_back( x.dca());
 
@@ -1066,7 +1220,6 @@ cat::JetCollection TtbarDiLeptonAnalyzer::selectBJets(const JetCollection& jets)
 
 void TtbarDiLeptonAnalyzer::setBranch(TTree* tr, systematic sys)
 {
-  tr->Branch("nvertex", &b_nvertex, "nvertex/I");
   tr->Branch("step", &b_step, "step/I");
   tr->Branch("channel", &b_channel, "channel/I");
   tr->Branch("njet", &b_njet, "njet/I");
@@ -1079,43 +1232,52 @@ void TtbarDiLeptonAnalyzer::setBranch(TTree* tr, systematic sys)
   tr->Branch("step6", &b_step6, "step6/O");
   tr->Branch("step7", &b_step7, "step7/O");
 
-  tr->Branch("lep1", "TLorentzVector", &b_lep1);
+  branchP4(tr, "lep1", &b_lep1);
   tr->Branch("lep1_pid", &b_lep1_pid, "lep1_pid/I");    
-  tr->Branch("lep2", "TLorentzVector", &b_lep2);
+  branchP4(tr, "lep2", &b_lep2);
   tr->Branch("lep2_pid", &b_lep2_pid, "lep2_pid/I");    
-  tr->Branch("dilep", "TLorentzVector", &b_dilep);
-  tr->Branch("jet1", "TLorentzVector", &b_jet1);
+  branchP4(tr, "dilep", &b_dilep);
+  branchP4(tr, "jet1", &b_jet1);
   tr->Branch("jet1_CSVInclV2", &b_jet1_CSVInclV2, "jet1_CSVInclV2/F");
-  tr->Branch("jet2", "TLorentzVector", &b_jet2);
+  branchP4(tr, "jet2", &b_jet2);
   tr->Branch("jet2_CSVInclV2", &b_jet2_CSVInclV2, "jet2_CSVInclV2/F");
-  tr->Branch("top1", "TLorentzVector", &b_top1);
-  tr->Branch("top2", "TLorentzVector", &b_top2);
-  tr->Branch("ttbar", "TLorentzVector", &b_ttbar);
+  branchP4(tr, "top1", &b_top1);
+  branchP4(tr, "top2", &b_top2);
+  branchP4(tr, "ttbar", &b_ttbar);
   tr->Branch("ttbar_dphi", &b_ttbar_dphi, "ttbar_dphi/F");
 
-  tr->Branch("desyjet1", "TLorentzVector", &b_desyjet1);
+  branchP4(tr, "desyjet1", &b_desyjet1);
   tr->Branch("desyjet1_CSVInclV2", &b_desyjet1_CSVInclV2, "desyjet1_CSVInclV2/F");
-  tr->Branch("desyjet2", "TLorentzVector", &b_desyjet2);
+  branchP4(tr, "desyjet2", &b_desyjet2);
   tr->Branch("desyjet2_CSVInclV2", &b_desyjet2_CSVInclV2, "desyjet2_CSVInclV2/F");
-  tr->Branch("desytop1", "TLorentzVector", &b_desytop1);
-  tr->Branch("desytop2", "TLorentzVector", &b_desytop2);    
-  tr->Branch("desyttbar", "TLorentzVector", &b_desyttbar);
+  branchP4(tr, "desytop1", &b_desytop1);
+  branchP4(tr, "desytop2", &b_desytop2);    
+  branchP4(tr, "desyttbar", &b_desyttbar);
   tr->Branch("desyttbar_dphi", &b_desyttbar_dphi, "desyttbar_dphi/F");
   
   tr->Branch("tri", &b_tri, "tri/F");
   tr->Branch("tri_up", &b_tri_up, "tri_up/F");
   tr->Branch("tri_dn", &b_tri_dn, "tri_dn/F");
-  tr->Branch("filtered", &b_filtered, "filtered/O");
   tr->Branch("met", &b_met, "met/F");
-  tr->Branch("weight", &b_weight, "weight/F");
-  tr->Branch("topPtWeight", &b_topPtWeight, "topPtWeight/F");
-  tr->Branch("puweight", &b_puweight, "puweight/F");
-  tr->Branch("genweight", &b_genweight, "genweight/F");
   tr->Branch("mueffweight", &b_mueffweight, "mueffweight/F");
   tr->Branch("eleffweight", &b_eleffweight, "eleffweight/F");
   tr->Branch("btagweight", &b_btagweight, "btagweight/F");
   tr->Branch("is3lep", &b_is3lep, "is3lep/I");
 
+  // Same as SystBranches up to here, the rest is taken from the nominal tree in the friend layout
+  if (useFriendTrees_ && sys != syst_nom) {
+    tr->Branch("csvweights","std::vector<float>",&b_csvweights);
+    tr->Branch("run", &b_run, "run/I");
+    tr->Branch("event", &b_event, "event/I");
+    return;
+  }
+  tr->Branch("nvertex", &b_nvertex, "nvertex/I");
+  tr->Branch("filtered", &b_filtered, "filtered/O");
+  tr->Branch("weight", &b_weight, "weight/F");
+  tr->Branch("topPtWeight", &b_topPtWeight, "topPtWeight/F");
+  tr->Branch("puweight", &b_puweight, "puweight/F");
+  tr->Branch("genweight", &b_genweight, "genweight/F");
+
   tr->Branch("partonChannel", &b_partonChannel, "partonChannel/I");
   tr->Branch("partonMode1", &b_partonMode1, "partonMode1/I");    
   tr->Branch("partonMode2", &b_partonMode2, "partonMode2/I");    
@@ -1150,44 +1312,68 @@ void TtbarDiLeptonAnalyzer::setBranch(TTree* tr, systematic sys)
   // tr->Branch("scaleWeights_dn","std::vector<float>",&b_scaleWeights_dn);
   tr->Branch("scaleWeights","std::vector<float>",&b_scaleWeights);
 
-  tr->Branch("partonlep1", "TLorentzVector", &b_partonlep1);
-  tr->Branch("partonlep2", "TLorentzVector", &b_partonlep2);
-  tr->Branch("partondilep", "TLorentzVector", &b_partondilep);
-  tr->Branch("partonjet1", "TLorentzVector", &b_partonjet1);
-  tr->Branch("partonjet2", "TLorentzVector", &b_partonjet2);
-  tr->Branch("partontop1", "TLorentzVector", &b_partontop1);
-  tr->Branch("partontop2", "TLorentzVector", &b_partontop2);
-  tr->Branch("partonttbar", "TLorentzVector", &b_partonttbar);
+  branchP4(tr, "partonlep1", &b_partonlep1);
+  branchP4(tr, "partonlep2", &b_partonlep2);
+  branchP4(tr, "partondilep", &b_partondilep);
+  branchP4(tr, "partonjet1", &b_partonjet1);
+  branchP4(tr, "partonjet2", &b_partonjet2);
+  branchP4(tr, "partontop1", &b_partontop1);
+  branchP4(tr, "partontop2", &b_partontop2);
+  branchP4(tr, "partonttbar", &b_partonttbar);
   tr->Branch("partonttbar_dphi", &b_partonttbar_dphi, "partonttbar_dphi/F");
 
-  tr->Branch("pseudolep1", "TLorentzVector", &b_pseudolep1);
-  tr->Branch("pseudolep2", "TLorentzVector", &b_pseudolep2);
-  tr->Branch("pseudodilep", "TLorentzVector", &b_pseudodilep);
-  tr->Branch("pseudojet1", "TLorentzVector", &b_pseudojet1);
-  tr->Branch("pseudojet2", "TLorentzVector", &b_pseudojet2);
-  tr->Branch("pseudotop1", "TLorentzVector", &b_pseudotop1);
-  tr->Branch("pseudotop2", "TLorentzVector", &b_pseudotop2);
-  tr->Branch("pseudottbar", "TLorentzVector", &b_pseudottbar);
+  branchP4(tr, "pseudolep1", &b_pseudolep1);
+  branchP4(tr, "pseudolep2", &b_pseudolep2);
+  branchP4(tr, "pseudodilep", &b_pseudodilep);
+  branchP4(tr, "pseudojet1", &b_pseudojet1);
+  branchP4(tr, "pseudojet2", &b_pseudojet2);
+  branchP4(tr, "pseudotop1", &b_pseudotop1);
+  branchP4(tr, "pseudotop2", &b_pseudotop2);
+  branchP4(tr, "pseudottbar", &b_pseudottbar);
   tr->Branch("pseudottbar_dphi", &b_pseudottbar_dphi, "pseudottbar_dphi/F");
 
 
   // ############### Dstar begin #######################
 
-  b_d0         = new TClonesArray("TLorentzVector",100);
-  b_d0_dau1    = new TClonesArray("TLorentzVector",100);
-  b_d0_dau2    = new TClonesArray("TLorentzVector",100);
-  b_dstar      = new TClonesArray("TLorentzVector",100);
-  b_dstar_dau1 = new TClonesArray("TLorentzVector",100);
-  b_dstar_dau2 = new TClonesArray("TLorentzVector",100);
-  b_dstar_dau3 = new TClonesArray("TLorentzVector",100);
-  b_Jpsi       = new TClonesArray("TLorentzVector",100);
-  b_Jpsi_dau1  = new TClonesArray("TLorentzVector",100);
-  b_Jpsi_dau2  = new TClonesArray("TLorentzVector",100);
+  if ( useFlatCharm_ ) {
+    b_d0_p4.branch(tr, "d0");
+    tr->Branch("d0_dau1_idx","std::vector<int>",&b_d0_dau1_idx);
+    tr->Branch("d0_dau2_idx","std::vector<int>",&b_d0_dau2_idx);
+    b_dstar_p4.branch(tr, "dstar");
+    tr->Branch("dstar_dau1_idx","std::vector<int>",&b_dstar_dau1_idx);
+    tr->Branch("dstar_dau2_idx","std::vector<int>",&b_dstar_dau2_idx);
+    tr->Branch("dstar_dau3_idx","std::vector<int>",&b_dstar_dau3_idx);
+    b_Jpsi_p4.branch(tr, "Jpsi");
+    tr->Branch("Jpsi_dau1_idx","std::vector<int>",&b_Jpsi_dau1_idx);
+    tr->Branch("Jpsi_dau2_idx","std::vector<int>",&b_Jpsi_dau2_idx);
+    b_charmDau_p4.branch(tr, "charmDau");
+    tr->Branch("charmDau_q","std::vector<float>",&b_charmDau_q);
+  }
+  else {
+    b_d0         = new TClonesArray("TLorentzVector",100);
+    b_d0_dau1    = new TClonesArray("TLorentzVector",100);
+    b_d0_dau2    = new TClonesArray("TLorentzVector",100);
+    b_dstar      = new TClonesArray("TLorentzVector",100);
+    b_dstar_dau1 = new TClonesArray("TLorentzVector",100);
+    b_dstar_dau2 = new TClonesArray("TLorentzVector",100);
+    b_dstar_dau3 = new TClonesArray("TLorentzVector",100);
+    b_Jpsi       = new TClonesArray("TLorentzVector",100);
+    b_Jpsi_dau1  = new TClonesArray("TLorentzVector",100);
+    b_Jpsi_dau2  = new TClonesArray("TLorentzVector",100);
+
+    tr->Branch("d0","TClonesArray",&b_d0,32000,0);
+    tr->Branch("d0_dau1","TClonesArray",&b_d0_dau1,32000,0);
+    tr->Branch("d0_dau2","TClonesArray",&b_d0_dau2,32000,0);
+    tr->Branch("dstar",    "TClonesArray",&b_dstar    ,32000,0);
+    tr->Branch("dstar_dau1","TClonesArray",&b_dstar_dau1,32000,0);
+    tr->Branch("dstar_dau2","TClonesArray",&b_dstar_dau2,32000,0);
+    tr->Branch("dstar_dau3","TClonesArray",&b_dstar_dau3,32000,0);
+    tr->Branch("Jpsi","TClonesArray",&b_Jpsi,32000,0);
+    tr->Branch("Jpsi_dau1","TClonesArray",&b_Jpsi_dau1,32000,0);
+    tr->Branch("Jpsi_dau2","TClonesArray",&b_Jpsi_dau2,32000,0);
+  }
 
   // D0
-  tr->Branch("d0","TClonesArray",&b_d0,32000,0);
-  tr->Branch("d0_dau1","TClonesArray",&b_d0_dau1,32000,0);
-  tr->Branch("d0_dau2","TClonesArray",&b_d0_dau2,32000,0);
   tr->Branch("d0_vProb","std::vector<float>",&b_d0_vProb);
 
   tr->Branch("d0_true","std::vector<bool>",&b_d0_true);
@@ -1206,11 +1392,6 @@ void TtbarDiLeptonAnalyzer::setBranch(TTree* tr, systematic sys)
   tr->Branch("d0_lepSV_dRM","std::vector<float>",&b_d0_lepSV_dRM);
   tr->Branch("d0_lepSV_correctM","std::vector<float>",&b_d0_lepSV_correctM); // for test
 
-  tr->Branch("dstar",    "TClonesArray",&b_dstar    ,32000,0);
-  tr->Branch("dstar_dau1","TClonesArray",&b_dstar_dau1,32000,0);
-  tr->Branch("dstar_dau2","TClonesArray",&b_dstar_dau2,32000,0);
-  tr->Branch("dstar_dau3","TClonesArray",&b_dstar_dau3,32000,0);
-
   tr->Branch("dstar_true","std::vector<bool>",&b_dstar_true);
   tr->Branch("dstar_fit","std::vector<bool>",&b_dstar_fit);
   tr->Branch("dstar_L3D","std::vector<float>",&b_dstar_L3D);
@@ -1232,9 +1413,6 @@ void TtbarDiLeptonAnalyzer::setBranch(TTree* tr, systematic sys)
   tr->Branch("dstar_opCharge_M","std::vector<float>",&b_dstar_opCharge_M);
   tr->Branch("dstar_lepSV_correctM","std::vector<float>",&b_dstar_lepSV_correctM);
 
-  tr->Branch("Jpsi","TClonesArray",&b_Jpsi,32000,0);
-  tr->Branch("Jpsi_dau1","TClonesArray",&b_Jpsi_dau1,32000,0);
-  tr->Branch("Jpsi_dau2","TClonesArray",&b_Jpsi_dau2,32000,0);
   tr->Branch("Jpsi_vProb","std::vector<float>",&b_Jpsi_vProb);
 
   tr->Branch("Jpsi_true","std::vector<bool>",&b_Jpsi_true);
@@ -1259,6 +1437,83 @@ void TtbarDiLeptonAnalyzer::setBranch(TTree* tr, systematic sys)
 
 }
 
+void TtbarDiLeptonAnalyzer::branchP4(TTree* tr, const std::string& name, TLorentzVector* p4)
+{
+  if ( !useFlatP4_ ) {
+    tr->Branch(name.c_str(), "TLorentzVector", p4);
+    return;
+  }
+
+  // Same storage for every tree, the trees are filled one after the other
+  auto& x = flatP4s_[name];
+  x.p4 = p4;
+  auto bitsItr = flatP4Bits_.find(name);
+  if ( bitsItr == flatP4Bits_.end() ) bitsItr = flatP4Bits_.find("mantissaBits");
+  x.mantissaBits = bitsItr == flatP4Bits_.end() ? 23 : bitsItr->second;
+
+  tr->Branch((name+"_pt" ).c_str(), &x.pt , (name+"_pt/F" ).c_str());
+  tr->Branch((name+"_eta").c_str(), &x.eta, (name+"_eta/F").c_str());
+  tr->Branch((name+"_phi").c_str(), &x.phi, (name+"_phi/F").c_str());
+  tr->Branch((name+"_m"  ).c_str(), &x.m  , (name+"_m/F"  ).c_str());
+}
+
+// Round to nBits of mantissa, the zeroed low bits compress away in the baskets
+static float truncateMantissa(float x, const int nBits)
+{
+  if ( nBits >= 23 or !std::isfinite(x) ) return x;
+  const uint32_t nDrop = 23-nBits;
+  uint32_t bits;
+  std::memcpy(&bits, &x, sizeof(bits));
+  bits += uint32_t(1) << (nDrop-1);
+  bits &= ~((uint32_t(1) << nDrop)-1);
+  std::memcpy(&x, &bits, sizeof(bits));
+  return x;
+}
+
+void TtbarDiLeptonAnalyzer::fillFlatP4()
+{
+  for ( auto& item : flatP4s_ ) {
+    auto& x = item.second;
+    const auto& p4 = *x.p4;
+    const double pt = p4.Pt();
+    // TLorentzVector::Eta() warns for pt=0, which is the case of the empty vectors
+    x.pt  = truncateMantissa(pt, x.mantissaBits);
+    x.eta = pt == 0 ? 0 : truncateMantissa(p4.Eta(), x.mantissaBits);
+    x.phi = truncateMantissa(p4.Phi(), x.mantissaBits);
+    x.m   = truncateMantissa(p4.M(), x.mantissaBits);
+  }
+}
+
+void TtbarDiLeptonAnalyzer::P4Array::branch(TTree* tr, const std::string& name)
+{
+  tr->Branch((name+"_pt" ).c_str(), "std::vector<float>", &pt);
+  tr->Branch((name+"_eta").c_str(), "std::vector<float>", &eta);
+  tr->Branch((name+"_phi").c_str(), "std::vector<float>", &phi);
+  tr->Branch((name+"_m"  ).c_str(), "std::vector<float>", &m);
+}
+
+void TtbarDiLeptonAnalyzer::P4Array::push_back(const TLorentzVector& p4)
+{
+  pt.push_back(p4.Pt());
+  eta.push_back(p4.Pt() == 0 ? 0 : p4.Eta());
+  phi.push_back(p4.Phi());
+  m.push_back(p4.M());
+}
+
+int TtbarDiLeptonAnalyzer::charmDaughterIndex(const reco::Candidate& dau)
+{
+  // The daughters are copies of the tracks, the same track gives exactly the same values
+  const auto key = std::make_tuple(float(dau.pt()), float(dau.eta()), float(dau.phi()), dau.charge());
+  auto itr = charmDauIdx_.find(key);
+  if ( itr != charmDauIdx_.end() ) return itr->second;
+
+  const int idx = b_charmDau_q.size();
+  charmDauIdx_[key] = idx;
+  b_charmDau_p4.push_back(ToTLorentzVector(dau));
+  b_charmDau_q.push_back(dau.charge());
+  return idx;
+}
+
 void TtbarDiLeptonAnalyzer::resetBranch()
 {
   b_nvertex = 0;b_step = -1;b_channel = 0;b_njet = 0;b_nbjet = 0;
@@ -1308,9 +1563,17 @@ void TtbarDiLeptonAnalyzer::resetBranch()
   b_desyttbar = TLorentzVector();
   b_desyttbar_dphi = 0;
 
-  b_d0->Clear();    b_d0_dau1->Clear();    b_d0_dau2->Clear();
-  b_dstar->Clear(); b_dstar_dau1->Clear(); b_dstar_dau2->Clear(); b_dstar_dau3->Clear();
-  b_Jpsi->Clear();    b_Jpsi_dau1->Clear();    b_Jpsi_dau2->Clear();
+  if ( useFlatCharm_ ) {
+    b_d0_p4.clear(); b_d0_dau1_idx.clear(); b_d0_dau2_idx.clear();
+    b_dstar_p4.clear(); b_dstar_dau1_idx.clear(); b_dstar_dau2_idx.clear(); b_dstar_dau3_idx.clear();
+    b_Jpsi_p4.clear(); b_Jpsi_dau1_idx.clear(); b_Jpsi_dau2_idx.clear();
+    b_charmDau_p4.clear(); b_charmDau_q.clear(); charmDauIdx_.clear();
+  }
+  else {
+    b_d0->Clear();    b_d0_dau1->Clear();    b_d0_dau2->Clear();
+    b_dstar->Clear(); b_dstar_dau1->Clear(); b_dstar_dau2->Clear(); b_dstar_dau3->Clear();
+    b_Jpsi->Clear();    b_Jpsi_dau1->Clear();    b_Jpsi_dau2->Clear();
+  }
 
   // ##################### Dstar begin ######################
   // D0
@@ -69,6 +69,7 @@ private:
   //edm::EDGetTokenT<edm::TriggerResults> triggerBits_;
   vector<edm::EDGetTokenT<edm::TriggerResults>> triggerBits_;
   edm::EDGetTokenT<pat::TriggerObjectStandAloneCollection> triggerObjects_;
+  cat::TriggerPathIndex trigPathIndex_;
 
   RoccoR *rocCor;
 
@@ -154,7 +155,11 @@ h2muAnalyzer::h2muAnalyzer(const edm::ParameterSet& iConfig)
   }
   
  //rocCor = new RoccoR(edm::FileInPath("CATTools/CatAnalyzer/data/rcdata.2016.v3/").fullPath());  
- rocCor = new RoccoR(std::string(std::getenv("CMSSW_BASE"))+"/src/CATTools/CatAnalyzer/data/rcdata.2016.v3/");
+ const std::string rocCorDir = std::string(std::getenv("CMSSW_BASE"))+"/src/CATTools/CatAnalyzer/data/rcdata.2016.v3/";
+ rocCor = new RoccoR(rocCorDir, rocCorDir+"rcdata.bin");
+ // Interpolated CrystalBall inverse CDF in the MC smearing on this many points, 0 for the analytic one
+ const int rocCorNGrid = iConfig.existsAs<int>("rocCorTabulate") ? iConfig.getParameter<int>("rocCorTabulate") : 0;
+ if (rocCorNGrid > 0) rocCor->tabulate(rocCorNGrid);
 
 }
 
@@ -328,7 +333,7 @@ bool h2muAnalyzer::eventSelection(const edm::Event& iEvent, systematic sys)
   edm::Handle<pat::TriggerObjectStandAloneCollection> triggerObjects;
   iEvent.getByToken(triggerObjects_, triggerObjects);
   const edm::TriggerNames &triggerNames = iEvent.triggerNames(*triggerBits);
-  AnalysisHelper trigHelper = AnalysisHelper(triggerNames, triggerBits, triggerObjects);
+  AnalysisHelper trigHelper = AnalysisHelper(triggerNames, triggerBits, triggerObjects, trigPathIndex_);
 
   if (!trigHelper.triggerFired("HLT_IsoMu24_v") && !trigHelper.triggerFired("HLT_IsoTkMu24_v")){
     return true;  
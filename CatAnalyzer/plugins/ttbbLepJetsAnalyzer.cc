@@ -74,6 +74,7 @@ private:
   unsigned int SkimNJets_;
   bool KFUsebtag_;
   bool CSVPosConKF_;
+  bool KFGaussNewton_;
   // Trigger Names
   std::vector<string> triggerNameDataEl_;
   std::vector<string> triggerNameDataMu_;
@@ -105,6 +106,7 @@ private:
   edm::EDGetTokenT<edm::TriggerResults> triggerBits_;
   edm::EDGetTokenT<edm::TriggerResults> triggerBits2_;
   edm::EDGetTokenT<pat::TriggerObjectStandAloneCollection> triggerObjects_;
+  cat::TriggerPathIndex trigPathIndex_;
 
 // ----------member data ---------------------------
 
@@ -272,6 +274,7 @@ ttbbLepJetsAnalyzer::ttbbLepJetsAnalyzer(const edm::ParameterSet& iConfig):
   SkimNJets_  (iConfig.getUntrackedParameter<unsigned int>("Skim_N_Jets", 0)),
   KFUsebtag_  (iConfig.getUntrackedParameter<bool>("KFUsebtagLabel", true)),
   CSVPosConKF_(iConfig.getUntrackedParameter<bool>("CSVPosConKFLabel", true)),
+  KFGaussNewton_(iConfig.getUntrackedParameter<bool>("KFGaussNewton", false)),
   triggerNameDataEl_(iConfig.getUntrackedParameter<std::vector<string>>("triggerNameDataEl")),
   triggerNameDataMu_(iConfig.getUntrackedParameter<std::vector<string>>("triggerNameDataMu")),
   triggerNameMCEl_  (iConfig.getUntrackedParameter<std::vector<string>>("triggerNameMCEl")),
@@ -1242,7 +1245,7 @@ void ttbbLepJetsAnalyzer::analyze(const edm::Event& iEvent, const edm::EventSetu
   } 
   iEvent.getByToken(triggerObjects_, triggerObjects);
   const edm::TriggerNames &triggerNames = iEvent.triggerNames(*triggerBits);
-  AnalysisHelper trigHelper = AnalysisHelper(triggerNames, triggerBits, triggerObjects);
+  AnalysisHelper trigHelper = AnalysisHelper(triggerNames, triggerBits, triggerObjects, trigPathIndex_);
 
   bool IsTriggerMu = false;
   bool IsTriggerEl = false;
@@ -1495,7 +1498,7 @@ void ttbbLepJetsAnalyzer::analyze(const edm::Event& iEvent, const edm::EventSetu
 	KinJets.push_back(kjet);
       }
       
-      ttbb::FindHadronicTop(KinLep, KinJets, KinMET, KFUsebtag_, CSVPosConKF_, KinBestIndices, bestchi2, Kinnu, Kinblrefit, Kinbjrefit, Kinj1refit, Kinj2refit);
+      ttbb::FindHadronicTop(KinLep, KinJets, KinMET, KFUsebtag_, CSVPosConKF_, KinBestIndices, bestchi2, Kinnu, Kinblrefit, Kinbjrefit, Kinj1refit, Kinj2refit, KFGaussNewton_);
       
       // for (unsigned int iin =0; iin<KinBestIndices.size(); iin++) std::cout << KinBestIndices.at(iin) << std::endl;
       // std::cout << "Best Chi2 = " << bestchi2 << std::endl;
@@ -78,6 +78,8 @@ process.ttbbLepJets = cms.EDAnalyzer('ttbbLepJetsAnalyzer',
                                      # Constrain in Kin. Fitter using CSV position
                                      KFUsebtag         = cms.untracked.bool(True),
                                      CSVPosConKF       = cms.untracked.bool(True),
+                                     # Kin. Fitter with Levenberg-Marquardt instead of MIGRAD
+                                     KFGaussNewton     = cms.untracked.bool(False),
                                      # TriggerNames
                                      triggerNameDataEl = cms.untracked.vstring("HLT_Ele27_eta2p1_WPTight_Gsf_v","HLT_Ele32_eta2p1_WPTight_Gsf_v"), 
                                      triggerNameDataMu = cms.untracked.vstring("HLT_IsoMu24_v","HLT_IsoTkMu24_v"), 
@@ -1,4 +1,4 @@
-import math, array, ROOT, copy, CMS_lumi, tdrstyle
+import math, array, ROOT, copy, CMS_lumi, tdrstyle, os, json, re
 import PhysicsTools.PythonAnalysis.rootplot.core as rootplotcore
 tdrstyle.setTDRStyle()
 def defTH1(title, name, binning):
@@ -8,33 +8,161 @@ def defTH1(title, name, binning):
         hist = ROOT.TH1D(name, title, len(binning)-1, array.array('f', binning))
     return hist
 
+## Four-vectors are either TLorentzVector branches or float <name>_pt, _eta, _phi, _m branches
+## (flatP4 option of TtbarDiLeptonAnalyzer). Expressions are written for the TLorentzVector,
+## e.g. lep1.Pt(), and translated for the flat branches by flatP4Expr.
+_flatP4Methods = {
+    'Pt':'{0}_pt', 'Perp':'{0}_pt', 'Eta':'{0}_eta', 'Phi':'{0}_phi', 'M':'{0}_m',
+    'Px':'({0}_pt*cos({0}_phi))', 'Py':'({0}_pt*sin({0}_phi))', 'Pz':'({0}_pt*sinh({0}_eta))',
+    'P':'({0}_pt*cosh({0}_eta))',
+    ## same convention as TLorentzVector::SetPtEtaPhiM for negative masses
+    'E':'sqrt(TMath::Max(pow({0}_pt*cosh({0}_eta),2)+{0}_m*abs({0}_m),0.))',
+}
+_flatP4Methods['Rapidity'] = '(0.5*log(({1}+{0}_pt*sinh({0}_eta))/({1}-{0}_pt*sinh({0}_eta))))'.replace('{1}', _flatP4Methods['E'])
+_flatP4Pattern = re.compile(r'\b(\w+)\.(%s)\(\)' % '|'.join(_flatP4Methods.keys()))
+
+def isFlatP4(tree, name):
+    return not tree.GetBranch(name) and bool(tree.GetBranch(name+'_pt'))
+
+def flatP4Expr(tree, expr):
+    def replace(m):
+        if not isFlatP4(tree, m.group(1)): return m.group(0)
+        return _flatP4Methods[m.group(2)].format(m.group(1))
+    return _flatP4Pattern.sub(replace, expr)
+
+def getP4(tree, name):
+    ## TLorentzVector of the current entry in either format
+    if not isFlatP4(tree, name): return getattr(tree, name)
+    p4 = ROOT.TLorentzVector()
+    p4.SetPtEtaPhiM(getattr(tree, name+'_pt'), getattr(tree, name+'_eta'), getattr(tree, name+'_phi'), getattr(tree, name+'_m'))
+    return p4
+
+def getP4s(tree, name):
+    ## TLorentzVectors of the current entry for the charm candidates, e.g. d0 or d0_dau1,
+    ## from the TClonesArray or from the flatCharmCandidates arrays
+    if tree.GetBranch(name): return list(getattr(tree, name))
+    p4s = []
+    if tree.GetBranch(name+'_idx'):
+        idxs, name = getattr(tree, name+'_idx'), 'charmDau'
+    else:
+        idxs = range(getattr(tree, name+'_pt').size())
+    pt, eta, phi, m = [getattr(tree, name+x) for x in ('_pt', '_eta', '_phi', '_m')]
+    for i in idxs:
+        p4 = ROOT.TLorentzVector()
+        p4.SetPtEtaPhiM(pt[i], eta[i], phi[i], m[i])
+        p4s.append(p4)
+    return p4s
+
 def getTH1(title, binning, tree, plotvar, cut, scale = 0.):
+    ## TTree::Project finds the histogram by name in gDirectory. It is filled in memory (gROOT),
+    ## not in the file of the tree, and detached so that the next "name" does not replace it.
+    olddir = ROOT.gDirectory.GetDirectory('')
+    ROOT.gROOT.cd()
     hist = defTH1(title, "name", binning)
-    tree.Project("name", plotvar, cut)
+    tree.Project("name", flatP4Expr(tree, plotvar), flatP4Expr(tree, cut))
+    hist.SetDirectory(0)
+    olddir.cd()
     if hist.GetSumw2N() == 0:
         hist.Sumw2()
     if scale != 0:
         hist.Scale(scale)
-    return copy.deepcopy(hist)
+    return hist
+
+_openFiles = {}
+def openFile(filename):
+    ## keep files open to avoid reopening for every systematic variation, closeFiles() closes them
+    if filename not in _openFiles or not _openFiles[filename].IsOpen():
+        _openFiles[filename] = ROOT.TFile(filename)
+    return _openFiles[filename]
+
+def closeFiles():
+    for f in _openFiles.itervalues():
+        if f.IsOpen(): f.Close()
+    _openFiles.clear()
+
+def getTree(tfile, treename):
+    ## Variation trees of the friendSystematicTrees layout keep only the branches changed by the variation,
+    ## the rest is read from the nominal tree in the same directory through its run, event index.
+    ## The weights and the parton/pseudo top scalars then carry their nominal values, 1 and 0 in the full copy trees.
+    tree = tfile.Get(treename)
+    if tree and tree.GetBranch('run') and not tree.GetBranch('puweight_up') and not tree.GetListOfFriends():
+        nomname = '/'.join(treename.split('/')[:-1]+['nom'])
+        if nomname != treename and tfile.Get(nomname): tree.AddFriend(nomname)
+    return tree
 
 def makeTH1(filename, treename, title, binning, plotvar, cut, scale = 0.):
-    tfile = ROOT.TFile(filename)
-    tree  = tfile.Get(treename)
-    
+    olddir = ROOT.gDirectory.GetDirectory('')
+    tfile = openFile(filename)
+    tfile.cd()
+    tree  = getTree(tfile, treename)
+
+    ROOT.gROOT.cd()
     hist = defTH1(title, "tmp", binning)
+    hist.SetDirectory(0)
     for var in plotvar.split(','):
         hist.Add(getTH1(title, binning, tree, var, cut, scale))
-        
-    return copy.deepcopy(hist)
+    olddir.cd()
+
+    return hist
 
 def getEntries(filename, treename):
     tfile = ROOT.TFile(filename)
     tree  = tfile.Get(treename)
     return tree.GetEntriesFast()
 
+## Sums of weights are cached in a json file next to the ntuple, ntuple.root -> ntuple.sumw.json,
+## keyed by "tree|plotvar|weight". The cache is dropped if the ntuple is modified.
+def weightSumsFileName(filename):
+    if filename.endswith('.root'): return filename[:-5]+'.sumw.json'
+    return filename+'.sumw.json'
+
+_weightSums = {}
+def loadWeightSums(filename):
+    if filename in _weightSums: return _weightSums[filename]
+    st = os.stat(filename)
+    sums = {'mtime':st.st_mtime, 'size':st.st_size, 'sums':{}}
+    try:
+        cached = json.load(open(weightSumsFileName(filename)))
+        if cached['mtime'] == sums['mtime'] and cached['size'] == sums['size']: sums = cached
+    except (IOError, ValueError, KeyError):
+        pass
+    _weightSums[filename] = sums
+    return sums
+
+def saveWeightSums(filename):
+    try:
+        json.dump(_weightSums[filename], open(weightSumsFileName(filename), 'w'), indent=1)
+    except IOError:
+        pass ## read-only area, keep the sums in memory
+
+def getWeightSums(filename, treename, plotvar, weight):
+    ## Returns sum of weights and sum of squared weights
+    sums = loadWeightSums(filename)['sums']
+    key = '|'.join([treename, plotvar, weight])
+    if key not in sums:
+        weighthist = makeTH1(filename, treename, '', [1, 0, 1], plotvar, weight)
+        sumw = weighthist.Integral(-1,2)
+        sumw2 = sum(weighthist.GetBinError(b)**2 for b in range(0,3))
+        sums[key] = [sumw, sumw2]
+        saveWeightSums(filename)
+    return tuple(sums[key])
+
 def getWeightedEntries(filename, treename, plotvar, weight):
-    weighthist = makeTH1(filename, treename, '', [1, 0, 1], plotvar, weight)    
-    return weighthist.Integral(-1,2)
+    return getWeightSums(filename, treename, plotvar, weight)[0]
+
+def sysWeightSums(filename, treename, plotvar, weight, sysList):
+    ## (sumw, sumw2) of the nominal, and of the up and down variations for each systematic source,
+    ## same naming convention as in sysUncertainty. Computed once per ntuple and read from the cache after.
+    nom = getWeightSums(filename, treename, plotvar, weight)
+    sums_up, sums_dn = [], []
+    for sys in sysList:
+        if 'weight' not in sys:
+            sums_up.append(getWeightSums(filename, "cattree/%s_u"%sys, plotvar, weight))
+            sums_dn.append(getWeightSums(filename, "cattree/%s_d"%sys, plotvar, weight))
+        else:
+            sums_up.append(getWeightSums(filename, treename, plotvar, weight.replace(sys,'%s_up'%sys)))
+            sums_dn.append(getWeightSums(filename, treename, plotvar, weight.replace(sys,'%s_dn'%sys)))
+    return nom, sums_up, sums_dn
 
 def divide_canvas(canvas, ratio_fraction):
     margins = [ROOT.gStyle.GetPadTopMargin(), ROOT.gStyle.GetPadBottomMargin()]
@@ -26,6 +26,7 @@ ttbarDileptonKinAlgoPSetDESYSmeared = cms.PSet(
     nTrial = cms.int32(100),
     maxLBMass = cms.double(360),
     mTopInput = cms.double(172.5),
+    counterBasedRandom = cms.bool(False), # Random numbers from event number, combination and trial instead of the RandomNumberGeneratorService
 )
 
 ttbarDileptonKinAlgoPSetDESYMassLoop = cms.PSet(
@@ -10,15 +10,16 @@ double BTagWeightEvaluator::eventWeight(const cat::JetCollection& jets, const in
     // Method 1c) using scale factors only
     const int njet = jets.size();
     if ( njet == 0 ) return 1;
+    const int discrIndex = jets[0].bDiscriminatorIndex(btagAlgo_);
 
     double w0n = 1; // w(0|n) : weight of 0-tag among n-jets
     double w1n = 0; // w(1|n) : weight of 1-tag among n-jets
     for ( int i=0; i<njet; ++i ) {
-      w0n *= 1-getSF(jets[i], unc);
+      w0n *= 1-getSF(jets[i], unc, discrIndex);
       double prodw1n = 1;
       for ( int j=0; j<njet; ++j ) {
-        if ( i == j ) prodw1n *= getSF(jets[j], unc);
-        else prodw1n *= 1-getSF(jets[j], unc);
+        if ( i == j ) prodw1n *= getSF(jets[j], unc, discrIndex);
+        else prodw1n *= 1-getSF(jets[j], unc, discrIndex);
       }
       w1n += prodw1n;
     }
@@ -31,7 +32,8 @@ double BTagWeightEvaluator::eventWeight(const cat::JetCollection& jets, const in
     if ( type_ == ITERATIVEFIT ) {
       // Method 1d) using discriminator-dependent scale factors;
       double weight = 1.0;
-      for ( auto& jet : jets ) weight *= getSF(jet, unc);
+      const int discrIndex = jets.empty() ? -1 : jets[0].bDiscriminatorIndex(btagAlgo_);
+      for ( auto& jet : jets ) weight *= getSF(jet, unc, discrIndex);
       return weight;
     }
     else if ( type_ == CSVWEIGHT ) {
@@ -119,13 +121,18 @@ void BTagWeightEvaluator::init(const int method,
 }
 
 double BTagWeightEvaluator::getSF(const cat::Jet& jet, const int unc) const
+{
+  return getSF(jet, unc, jet.bDiscriminatorIndex(btagAlgo_));
+}
+
+double BTagWeightEvaluator::getSF(const cat::Jet& jet, const int unc, const int discrIndex) const
 {
   const double pt = std::min(jet.pt(), 999.);
   const double eta = jet.eta();
   const double aeta = std::abs(eta);
   if ( pt <= 20 or aeta >= 2.4 ) return 1.0;
 
-  double discr = jet.bDiscriminator(btagAlgo_);
+  double discr = jet.bDiscriminator(discrIndex);
   const int flav = std::abs(jet.hadronFlavour());
 
   if ( type_ == ITERATIVEFIT ) {
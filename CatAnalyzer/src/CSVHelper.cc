@@ -222,13 +222,14 @@ CSVHelper::getCSVWeight(cat::JetCollection jets, int iSys)//, double &csvWgtHF,
     double csvWgtC = 1.;
     double csvWgtlf = 1.;
 
+    const int csvIndex = jets.empty() ? -1 : jets.front().bDiscriminatorIndex("pfCombinedInclusiveSecondaryVertexV2BJetTags");
     for (auto jet1 = jets.begin(), end = jets.end(); jet1 != end; ++jet1){
     //for (int iJet = 0; iJet < int(jetPts.size()); iJet++) {
     //    double csv = jetCSVs[iJet];
     //    double jetPt = jetPts[iJet];
     //    double jetAbsEta = fabs(jetEtas[iJet]);
     //    int flavor = jetFlavors[iJet];
-        double csv = jet1->bDiscriminator("pfCombinedInclusiveSecondaryVertexV2BJetTags");
+        double csv = jet1->bDiscriminator(csvIndex);
         double jetPt = jet1->p4().pt();
         double jetAbsEta = std::fabs(jet1->p4().eta());
         int flavor = jet1->hadronFlavour();
@@ -0,0 +1,44 @@
+#include "CATTools/CatAnalyzer/interface/KinRecoInputs.h"
+#include "FWCore/Utilities/interface/Exception.h"
+#include "TFile.h"
+
+#include <map>
+#include <mutex>
+
+using namespace cat;
+
+std::shared_ptr<const KinRecoInputs> KinRecoInputs::get(const std::string& fullPath)
+{
+  // The cache holds weak references only, the inputs are deleted with their last user
+  static std::mutex mutex;
+  static std::map<std::string, std::weak_ptr<const KinRecoInputs> > cache;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto inputs = cache[fullPath].lock();
+  if ( !inputs ) {
+    inputs.reset(new KinRecoInputs(fullPath));
+    cache[fullPath] = inputs;
+  }
+  return inputs;
+}
+
+KinRecoInputs::KinRecoInputs(const std::string& fullPath)
+{
+  std::unique_ptr<TFile> f(TFile::Open(fullPath.c_str()));
+  if ( !f or f->IsZombie() ) throw cms::Exception("FileOpenError") << "Cannot open kinematic reconstruction input " << fullPath;
+
+  auto load = [&](std::unique_ptr<TH1>& h, const char* name) {
+    h.reset(dynamic_cast<TH1*>(f->Get(name)));
+    if ( !h ) throw cms::Exception("FileReadError") << "Cannot find " << name << " in " << fullPath;
+    h->SetDirectory(0);
+    h->GetIntegral();
+  };
+  load(h_jetEres_, "KinReco_fE_jet_step7");
+  load(h_jetAres_, "KinReco_d_angle_jet_step7");
+  load(h_lepEres_, "KinReco_fE_lep_step7");
+  load(h_lepAres_, "KinReco_d_angle_lep_step7");
+  load(h_wmass_, "KinReco_W_mass_step0");
+  load(h_mbl_w_, "KinReco_mbl_true_step0");
+
+  f->Close();
+}
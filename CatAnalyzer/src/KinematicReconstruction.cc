@@ -6,12 +6,14 @@
 #include <TLorentzVector.h>
 #include <TH1F.h>
 #include <TRandom3.h>
-#include <TFile.h>
 #include <TString.h>
 #include <TMath.h>
 #include <TVector3.h>
 #include <Math/VectorUtil.h>
 
+#include "tbb/parallel_for.h"
+#include "tbb/blocked_range.h"
+
 #include "CATTools/CatAnalyzer/interface/classes.h"
 #include "CATTools/CatAnalyzer/interface/utils.h"
 #include "CATTools/CatAnalyzer/interface/analysisUtils.h"
@@ -19,12 +21,14 @@
 #include "CATTools/CatAnalyzer/interface/KinematicReconstruction_LSroutines.h"
 #include "CATTools/CatAnalyzer/interface/KinematicReconstruction_MeanSol.h"
 #include "CATTools/CatAnalyzer/interface/KinematicReconstructionSolution.h"
+#include "CATTools/CatAnalyzer/interface/CounterBasedRandom.h"
+#include "CATTools/CatAnalyzer/interface/KinRecoInputs.h"
 
 constexpr double TopMASS = 172.5;
 
 // -------------------------------------- Methods for KinematicReconstruction --------------------------------------
 
-void KinematicReconstruction::angle_rot(const double& alpha, const double& e, const TLorentzVector& inJet, TLorentzVector& jet_sm)const
+void KinematicReconstruction::angle_rot(const double& alpha, const double& e, const TLorentzVector& inJet, TLorentzVector& jet_sm, cat::CounterBasedRandom* rng)const
 {
     double px_1, py_1, pz_1; // Coordinate system where momentum is along Z-axis
     
@@ -40,7 +44,7 @@ void KinematicReconstruction::angle_rot(const double& alpha, const double& e, co
     if(fabs(jet.Pz())<=e){jet.SetPz(0);}
     
     //Rotation in syst 1 ...
-    double phi = 2*TMath::Pi()*r3_->Rndm();
+    double phi = 2*TMath::Pi()*(rng ? rng->flat() : r3_->Rndm());
     pz_1 = jet.Vect().Mag()*cos(alpha);
     px_1 = - jet.Vect().Mag()*sin(alpha)*sin(phi);
     py_1 = jet.Vect().Mag()*sin(alpha)*cos(phi);  
@@ -90,10 +94,15 @@ void KinematicReconstruction::angle_rot(const double& alpha, const double& e, co
 
 
 
-KinematicReconstruction::KinematicReconstruction(const int minNumberOfBtags, const bool preferBtags, const bool massLoop):
+KinematicReconstruction::KinematicReconstruction(const int minNumberOfBtags, const bool preferBtags, const bool massLoop, const bool parallel,
+                                                 const bool counterBasedRandom):
 minNumberOfBtags_(minNumberOfBtags),
 preferBtags_(preferBtags),
 massLoop_(massLoop),
+parallel_(parallel),
+counterBasedRandom_(counterBasedRandom),
+randomKey_(0),
+r3_(0),
 nSol_(0),
 h_wmass_(0),
 h_jetAngleRes_(0),
@@ -110,10 +119,17 @@ h_mbl_w_(0)
                  <<minNumberOfBtags_<<"\n...break\n"<<std::endl;
         exit(96);
     }
+    if(parallel_ && !massLoop_ && !counterBasedRandom_){
+        std::cerr<<"ERROR in constructor of KinematicReconstruction! Parallel evaluation of the smearing needs the counter based "
+                 <<"random numbers, gRandom cannot be shared between threads\n...break\n"<<std::endl;
+        exit(97);
+    }
     
     std::cout<<"Require minimum number of b-tags per solution: "<<minNumberOfBtags_<<"\n";
     std::cout<<"Prefer solutions with more b-tags: "<<(preferBtags_ ? "yes" : "no")<<"\n";
     std::cout<<"Uncertainty treatment: "<<(massLoop_ ? "top mass scan" : "random-number based smearing")<<"\n";
+    std::cout<<"Evaluation of object combinations: "<<(parallel_ ? "parallel" : "serial")<<"\n";
+    if(!massLoop_) std::cout<<"Random numbers: "<<(counterBasedRandom_ ? "counter based, keyed by event" : "gRandom")<<"\n";
     
     // Read all histograms for smearings from file
     if(!massLoop_) this->loadData();
@@ -123,12 +139,29 @@ h_mbl_w_(0)
 
 
 
-void KinematicReconstruction::setRandomNumberSeeds(const LV& lepton, const LV& antiLepton, const LV& jet1, const LV& jet2)const
+unsigned int KinematicReconstruction::randomNumberSeed(const LV& lepton, const LV& antiLepton, const LV& jet1, const LV& jet2)const
 {
     // Asymmetric treatment of both jets and also both leptons, to ensure different seed for each combination
     const unsigned int seed =  std::abs(static_cast<int>( 1.e6*(jet1.pt()/jet2.pt()) * std::sin((lepton.Pt() + 2.*antiLepton.pt())*1.e6) ) );
-    gRandom->SetSeed(seed);
-    r3_->SetSeed(seed);
+    return seed;
+}
+
+
+
+double KinematicReconstruction::getRandom(TH1* h, cat::CounterBasedRandom* rng)const
+{
+    if(!rng) return h->GetRandom();
+    
+    const int n = h->GetNbinsX();
+    const double* integral = h->GetIntegral();
+    if(integral[n] == 0) return 0;
+    
+    const double r1 = rng->flat();
+    const int ibin = TMath::BinarySearch(n, integral, r1);
+    double x = h->GetBinLowEdge(ibin+1);
+    if(r1 > integral[ibin]) x += h->GetBinWidth(ibin+1)*(r1-integral[ibin])/(integral[ibin+1]-integral[ibin]);
+    
+    return x;
 }
 
 
@@ -145,16 +178,17 @@ KinematicReconstructionSolutions KinematicReconstruction::solutions(const std::v
     const int numberOfBtags(bjetIndices.size());
     if(!leptonIndices.size() || !antiLeptonIndices.size() || numberOfJets<2 || numberOfBtags<minNumberOfBtags_) return result;
     
+    std::vector<ObjectCombination> combinations;
+    
     // Find solutions with 2 b-tagged jets
     for(std::vector<int>::const_iterator i_index = bjetIndices.begin(); i_index != bjetIndices.end(); ++i_index)
         for(std::vector<int>::const_iterator j_index = i_index+1; j_index != bjetIndices.end(); ++j_index)
             for(const int leptonIndex : leptonIndices)
                 for(const int antiLeptonIndex : antiLeptonIndices){
-                    const std::vector<KinematicReconstructionSolution> solutions(this->solutionsPerObjectCombination(leptonIndex, antiLeptonIndex, *i_index, *j_index, allLeptons, allJets, btags, met, 2));
-                    result.addSolutions(solutions);
-                    const std::vector<KinematicReconstructionSolution> solutionsSwapped(this->solutionsPerObjectCombination(leptonIndex, antiLeptonIndex, *j_index, *i_index, allLeptons, allJets, btags, met, 2));
-                    result.addSolutions(solutionsSwapped);
+                    combinations.push_back({leptonIndex, antiLeptonIndex, *i_index, *j_index});
+                    combinations.push_back({leptonIndex, antiLeptonIndex, *j_index, *i_index});
                 }
+    this->addSolutionsPerObjectCombinations(result, combinations, allLeptons, allJets, btags, met, 2);
     if(preferBtags_ && result.numberOfSolutionsTwoBtags()) return result;
     if(minNumberOfBtags_ > 1) return result;
     
@@ -166,34 +200,69 @@ KinematicReconstructionSolutions KinematicReconstruction::solutions(const std::v
         if(std::find(bjetIndices.begin(), bjetIndices.end(), index) == bjetIndices.end()) nonBjetIndices.push_back(index);
     
     // Find solutions with 1 b-tagged jet
+    combinations.clear();
     for(const int bjetIndex : bjetIndices)
         for(const int nonBjetIndex : nonBjetIndices)
             for(const int leptonIndex : leptonIndices)
                 for(const int antiLeptonIndex : antiLeptonIndices){
-                    const std::vector<KinematicReconstructionSolution> solutions(this->solutionsPerObjectCombination(leptonIndex, antiLeptonIndex, bjetIndex, nonBjetIndex, allLeptons, allJets, btags, met, 1));
-                    result.addSolutions(solutions);
-                    const std::vector<KinematicReconstructionSolution> solutionsSwapped(this->solutionsPerObjectCombination(leptonIndex, antiLeptonIndex, nonBjetIndex, bjetIndex, allLeptons, allJets, btags, met, 1));
-                    result.addSolutions(solutionsSwapped);
+                    combinations.push_back({leptonIndex, antiLeptonIndex, bjetIndex, nonBjetIndex});
+                    combinations.push_back({leptonIndex, antiLeptonIndex, nonBjetIndex, bjetIndex});
                 }
+    this->addSolutionsPerObjectCombinations(result, combinations, allLeptons, allJets, btags, met, 1);
     if(preferBtags_ && result.numberOfSolutionsOneBtag()) return result;
     if(minNumberOfBtags_ > 0) return result;
     
     // Find solutions with 0 b-tagged jets
+    combinations.clear();
     for(std::vector<int>::const_iterator i_index = nonBjetIndices.begin(); i_index != nonBjetIndices.end(); ++i_index)
         for(std::vector<int>::const_iterator j_index = i_index+1; j_index != nonBjetIndices.end(); ++j_index)
             for(const int leptonIndex : leptonIndices)
                 for(const int antiLeptonIndex : antiLeptonIndices){
-                    const std::vector<KinematicReconstructionSolution> solutions(this->solutionsPerObjectCombination(leptonIndex, antiLeptonIndex, *i_index, *j_index, allLeptons, allJets, btags, met, 0));
-                    result.addSolutions(solutions);
-                    const std::vector<KinematicReconstructionSolution> solutionsSwapped(this->solutionsPerObjectCombination(leptonIndex, antiLeptonIndex, *j_index, *i_index, allLeptons, allJets, btags, met, 0));
-                    result.addSolutions(solutionsSwapped);
+                    combinations.push_back({leptonIndex, antiLeptonIndex, *i_index, *j_index});
+                    combinations.push_back({leptonIndex, antiLeptonIndex, *j_index, *i_index});
                 }
+    this->addSolutionsPerObjectCombinations(result, combinations, allLeptons, allJets, btags, met, 0);
     
     return result;
 }
 
 
 
+void KinematicReconstruction::addSolutionsPerObjectCombinations(KinematicReconstructionSolutions& result,
+                                                                const std::vector<ObjectCombination>& combinations,
+                                                                const VLV& allLeptons,
+                                                                const VLV& allJets, const std::vector<double>& btags,
+                                                                const LV& met,
+                                                                const int numberOfBtags)const
+{
+    // Each combination writes to its own slot, the solutions are added in the order of the combinations
+    // so that the result does not depend on how the combinations were scheduled
+    std::vector<std::vector<KinematicReconstructionSolution> > v_solutions(combinations.size());
+    this->forEachCombination(combinations.size(), [&](const size_t i){
+        const ObjectCombination& c = combinations[i];
+        v_solutions[i] = this->solutionsPerObjectCombination(c.leptonIndex, c.antiLeptonIndex, c.jetIndex1, c.jetIndex2,
+                                                             allLeptons, allJets, btags, met, numberOfBtags);
+    });
+    for(const auto& solutions : v_solutions) result.addSolutions(solutions);
+}
+
+
+
+void KinematicReconstruction::forEachCombination(const size_t n, const std::function<void(const size_t)>& function)const
+{
+    if(!parallel_ || n < 2){
+        for(size_t i = 0; i < n; ++i) function(i);
+        return;
+    }
+    
+    // One combination is 100 smearing trials, worth a task on its own
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, n, 1), [&](const tbb::blocked_range<size_t>& range){
+        for(size_t i = range.begin(); i != range.end(); ++i) function(i);
+    });
+}
+
+
+
 std::vector<KinematicReconstructionSolution> KinematicReconstruction::solutionsPerObjectCombination(const int leptonIndex, const int antiLeptonIndex,
                                                                                                     const int jetIndex1, const int jetIndex2,
                                                                                                     const VLV& allLeptons,
@@ -277,18 +346,22 @@ void KinematicReconstruction::kinReco(const LV& leptonMinus, const LV& leptonPlu
     this->inputNoJetMerging(b1_id, b2_id, nb_tag, *btags);
     if(b1_id.size() < 2)return;     
 
-    KinematicReconstruction_MeanSol meanSolution(TopMASS);
+    // Smearing of all combinations, each with its own mean solution
+    std::vector<KinematicReconstruction_MeanSol> v_meanSolution(b1_id.size(), KinematicReconstruction_MeanSol(TopMASS));
+    std::vector<char> v_hasSolution(b1_id.size(), false);
+    this->forEachCombination(b1_id.size(), [&](const size_t ib){
+        const LV& jet1 = new_jets.at(b1_id.at(ib));
+        const LV& jet2 = new_jets.at(b2_id.at(ib));
+        v_hasSolution[ib] = this->solutionSmearing(v_meanSolution[ib], leptonMinus, leptonPlus, jet1, jet2, *met);
+    });
+    
     for(int ib = 0; ib < (int)b1_id.size(); ++ib){
         const int bjetIndex = b1_id.at(ib);
         const int antiBjetIndex = b2_id.at(ib);
         const int numberOfBtags = nb_tag.at(ib);
+        KinematicReconstruction_MeanSol& meanSolution = v_meanSolution[ib];
         
-        const LV& jet1 = new_jets.at(bjetIndex);
-        const LV& jet2 = new_jets.at(antiBjetIndex);
-        
-        const bool hasSolution(this->solutionSmearing(meanSolution, leptonMinus, leptonPlus, jet1, jet2, *met));
-        
-        if(hasSolution){
+        if(v_hasSolution[ib]){
             meanSolution.getMeanSol(sol_.top, sol_.topBar, sol_.neutrino, sol_.neutrinoBar);
             sol_.weight = meanSolution.getSumWeight();
             sol_.Wplus = sol_.lp + sol_.neutrino;
@@ -299,7 +372,6 @@ void KinematicReconstruction::kinReco(const LV& leptonMinus, const LV& leptonPlu
             sol_.ntags = numberOfBtags;
             sols_.push_back(sol_);
         }
-        meanSolution.clear();
     }
 
     this->setSolutions();
@@ -312,8 +384,15 @@ bool KinematicReconstruction::solutionSmearing(KinematicReconstruction_MeanSol&
                                                const LV& jet1, const LV& jet2,
                                                const LV& met)const
 {
-    // Set random number generator seeds
-    this->setRandomNumberSeeds(lepton, antiLepton, jet1, jet2);
+    const unsigned int seed = this->randomNumberSeed(lepton, antiLepton, jet1, jet2);
+    // Counter based: the random numbers of each smearing trial are fixed by the event, the kinematics of the combination
+    // and the trial number, independent of any other combination or trial. Else gRandom and r3_ are reseeded
+    cat::CounterBasedRandom counterRng(randomKey_, seed);
+    cat::CounterBasedRandom* rng = counterBasedRandom_ ? &counterRng : 0;
+    if(!rng){
+        gRandom->SetSeed(seed);
+        r3_->SetSeed(seed);
+    }
     
     const TLorentzVector l_temp = common::LVtoTLV(lepton);
     const TLorentzVector al_temp = common::LVtoTLV(antiLepton);
@@ -328,6 +407,7 @@ bool KinematicReconstruction::solutionSmearing(KinematicReconstruction_MeanSol&
         TVector3 vX_reco =  - b_temp.Vect() - bbar_temp.Vect() - l_temp.Vect() - al_temp.Vect() - met_temp.Vect();
         
         for(int sm=0; sm<100; ++sm){
+            if(rng) rng->setTrial(sm);
             TLorentzVector b_sm=b_temp;
             TLorentzVector bbar_sm=bbar_temp;
             TLorentzVector met_sm;
@@ -336,27 +416,27 @@ bool KinematicReconstruction::solutionSmearing(KinematicReconstruction_MeanSol&
 //#define KINRECONOSM
 #ifndef KINRECONOSM
             //jets energy smearing
-            double fB=h_jetEres_->GetRandom();//fB=1;  //sm off
+            double fB=this->getRandom(h_jetEres_, rng);//fB=1;  //sm off
             double xB=sqrt((fB*fB*b_sm.E()*b_sm.E()-b_sm.M2())/(b_sm.P()*b_sm.P()));
-            double fBbar=h_jetEres_->GetRandom();//fBbar=1; //sm off
+            double fBbar=this->getRandom(h_jetEres_, rng);//fBbar=1; //sm off
             double xBbar=sqrt((fBbar*fBbar*bbar_sm.E()*bbar_sm.E()-bbar_sm.M2())/(bbar_sm.P()*bbar_sm.P()));
             //leptons energy smearing
-            double fL=h_lepEres_->GetRandom();//fL=1; //sm off
+            double fL=this->getRandom(h_lepEres_, rng);//fL=1; //sm off
             double xL=sqrt((fL*fL*l_sm.E()*l_sm.E()-l_sm.M2())/(l_sm.P()*l_sm.P()));
-            double faL=h_lepEres_->GetRandom();//faL=1;  //sm off
+            double faL=this->getRandom(h_lepEres_, rng);//faL=1;  //sm off
             double xaL=sqrt((faL*faL*al_sm.E()*al_sm.E()-al_sm.M2())/(al_sm.P()*al_sm.P()));
             //b-jet angle smearing
             b_sm.SetXYZT(b_sm.Px()*xB,b_sm.Py()*xB,b_sm.Pz()*xB,b_sm.E()*fB);
-            angle_rot(h_jetAngleRes_->GetRandom(),0.001,b_sm,b_sm);
+            angle_rot(this->getRandom(h_jetAngleRes_, rng),0.001,b_sm,b_sm,rng);
             //bbar jet angel smearing
             bbar_sm.SetXYZT(bbar_sm.Px()*xBbar,bbar_sm.Py()*xBbar,bbar_sm.Pz()*xBbar,bbar_sm.E()*fBbar);    
-            angle_rot(h_jetAngleRes_->GetRandom(),0.001,bbar_sm,bbar_sm);
+            angle_rot(this->getRandom(h_jetAngleRes_, rng),0.001,bbar_sm,bbar_sm,rng);
             //lepton angle smearing
             l_sm.SetXYZT(l_sm.Px()*xL,l_sm.Py()*xL,l_sm.Pz()*xL,l_sm.E()*fL);
-            angle_rot(h_lepAngleRes_->GetRandom(),0.001,l_sm,l_sm);
+            angle_rot(this->getRandom(h_lepAngleRes_, rng),0.001,l_sm,l_sm,rng);
             // anti lepton angle smearing
             al_sm.SetXYZT(al_sm.Px()*xaL,al_sm.Py()*xaL,al_sm.Pz()*xaL,al_sm.E()*faL);
-            angle_rot(h_lepAngleRes_->GetRandom(),0.001,al_sm,al_sm);
+            angle_rot(this->getRandom(h_lepAngleRes_, rng),0.001,al_sm,al_sm,rng);
 #endif
             
             
@@ -364,7 +444,7 @@ bool KinematicReconstruction::solutionSmearing(KinematicReconstruction_MeanSol&
                 met_sm.SetXYZM(metV3_sm.Px(),metV3_sm.Py(),0,0);
             
 #ifndef KINRECONOSM
-            KinematicReconstruction_LSroutines tp_sm(h_wmass_->GetRandom(),h_wmass_->GetRandom());
+            KinematicReconstruction_LSroutines tp_sm(this->getRandom(h_wmass_, rng),this->getRandom(h_wmass_, rng));
 #else
             KinematicReconstruction_LSroutines tp_sm(80.4, 80.4);
 #endif
@@ -375,7 +455,7 @@ bool KinematicReconstruction::solutionSmearing(KinematicReconstruction_MeanSol&
                 isHaveSol = true;
                 // FIXME: this loop is processed only once by definition, what is it needed for?
                 for(int i=0; i<=tp_sm.getNsol()*0; ++i){
-                    double mbl_weight = h_mbl_w_->GetBinContent(h_mbl_w_->FindBin((al_sm+b_sm).M()))*h_mbl_w_->GetBinContent(h_mbl_w_->FindBin((l_sm+bbar_sm).M()))/100000000;
+                    double mbl_weight = h_mbl_w_->GetBinContent(h_mbl_w_->FindFixBin((al_sm+b_sm).M()))*h_mbl_w_->GetBinContent(h_mbl_w_->FindFixBin((l_sm+bbar_sm).M()))/100000000;
                     meanSolution.add(tp_sm.getTtSol()->at(i).top,tp_sm.getTtSol()->at(i).topbar,tp_sm.getTtSol()->at(i).neutrino,tp_sm.getTtSol()->at(i).neutrinobar,mbl_weight);
                 }
             }
@@ -460,28 +540,21 @@ void KinematicReconstruction::loadData()
     TString data_path1 = common::DATA_PATH_COMMON();
     data_path1.Append("/KinReco_input.root");
     
-    TFile dataFile(data_path1);
+    // Histograms are shared with the other instances reading the same file,
+    // their cumulative integrals for the random numbers are already computed
+    inputs_ = cat::KinRecoInputs::get(data_path1.Data());
     //jet angle resolution
-        h_jetAngleRes_ = (TH1F*)dataFile.Get("KinReco_d_angle_jet_step7");
-        h_jetAngleRes_->SetDirectory(0);
+        h_jetAngleRes_ = inputs_->jetAres();
     //jet energy resolution
-        h_jetEres_ = (TH1F*)dataFile.Get("KinReco_fE_jet_step7");
-        h_jetEres_->SetDirectory(0);
+        h_jetEres_ = inputs_->jetEres();
     //lep angle resolution
-        h_lepAngleRes_ = (TH1F*)dataFile.Get("KinReco_d_angle_lep_step7");
-        h_lepAngleRes_->SetDirectory(0);
+        h_lepAngleRes_ = inputs_->lepAres();
     //lep energy resolution
-        h_lepEres_ = (TH1F*)dataFile.Get("KinReco_fE_lep_step7");
-        h_lepEres_->SetDirectory(0);
+        h_lepEres_ = inputs_->lepEres();
     //mbl mass
-        h_mbl_w_ = (TH1F*)dataFile.Get("KinReco_mbl_true_step0");
-        h_mbl_w_->SetDirectory(0);
-        //h_mbl_w_ = (TH1F*)dataFile.Get("KinReco_mbl_true_wrong_step0");
-        //h_mbl_w_->SetDirectory(0);
+        h_mbl_w_ = inputs_->mbl_w();
     // W mass
-        h_wmass_ = (TH1F*)dataFile.Get("KinReco_W_mass_step0");
-        h_wmass_->SetDirectory(0);
-    dataFile.Close();
+        h_wmass_ = inputs_->wmass();
 // ...
     std::cout<<"Found all histograms needed for smearing\n";
 }
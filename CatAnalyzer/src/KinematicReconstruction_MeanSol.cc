@@ -11,10 +11,10 @@
 
 
 KinematicReconstruction_MeanSol::KinematicReconstruction_MeanSol(const double& topm):
-sum_weight_(0),
-max_sum_weight_(0),
 mass_top_(topm)
-{}
+{
+    this->clear();
+}
 
 
 
@@ -25,24 +25,42 @@ KinematicReconstruction_MeanSol::~KinematicReconstruction_MeanSol()
 
 void KinematicReconstruction_MeanSol::clear()
 {
-    v_top_.clear();
-    v_topbar_.clear();
-    v_n_.clear();
-    v_nbar_.clear();
-    v_weight_.clear();
+    sum_top_.clear();
+    sum_topbar_.clear();
+    sum_n_.clear();
+    sum_nbar_.clear();
+    nsol_=0;
     sum_weight_=0;
     max_sum_weight_=0;
+    max_weight_=0;
+}
+
+
+
+void KinematicReconstruction_MeanSol::WeightedSum::add(const TLorentzVector& lv, const double& weight)
+{
+    px=px+weight*lv.Px();
+    py=py+weight*lv.Py();
+    pz=pz+weight*lv.Pz();
 }
 
 
 
 void KinematicReconstruction_MeanSol::add(const TLorentzVector& top, const TLorentzVector& topbar, const TLorentzVector& n, const TLorentzVector& nbar,const double& weight,const double& mbl_weight)
 {
-    v_top_.push_back(top);
-    v_topbar_.push_back(topbar);
-    v_n_.push_back(n);
-    v_nbar_.push_back(nbar);
-    v_weight_.push_back(weight);
+    sum_top_.add(top, weight);
+    sum_topbar_.add(topbar, weight);
+    sum_n_.add(n, weight);
+    sum_nbar_.add(nbar, weight);
+    
+    if(nsol_==0 || weight>max_weight_){
+        max_weight_ = weight;
+        max_top_ = top;
+        max_topbar_ = topbar;
+        max_n_ = n;
+        max_nbar_ = nbar;
+    }
+    ++nsol_;
     
     sum_weight_ = sum_weight_ + weight;
     max_sum_weight_ = max_sum_weight_ + mbl_weight;
@@ -52,37 +70,17 @@ void KinematicReconstruction_MeanSol::add(const TLorentzVector& top, const TLore
 
 void KinematicReconstruction_MeanSol::add(const TLorentzVector& top, const TLorentzVector& topbar,const TLorentzVector& n,const TLorentzVector& nbar,const double& weight)
 {
-    v_top_.push_back(top);
-    v_topbar_.push_back(topbar);
-    v_n_.push_back(n);
-    v_nbar_.push_back(nbar);
-    v_weight_.push_back(weight);
-    
-    sum_weight_ = sum_weight_ + weight;
-    max_sum_weight_ = max_sum_weight_ +weight;
+    this->add(top, topbar, n, nbar, weight, weight);
 }
 
 
 
-void KinematicReconstruction_MeanSol::getMeanVect(TLorentzVector& lv, const std::vector<TLorentzVector>& vlv, const double& mass)const
+void KinematicReconstruction_MeanSol::getMeanVect(TLorentzVector& lv, const WeightedSum& sum, const double& mass)const
 {
-    double px_sum=0;
-    double py_sum=0;
-    double pz_sum=0;
-    double px=0;
-    double py=0;
-    double pz=0;
-    
-    for(int i=0;i<((int)vlv.size());++i)
-    {
-          px_sum=px_sum+v_weight_.at(i)*vlv.at(i).Px();
-          py_sum=py_sum+v_weight_.at(i)*vlv.at(i).Py();
-          pz_sum=pz_sum+v_weight_.at(i)*vlv.at(i).Pz();
-    }
-    
-    px=px_sum/sum_weight_;
-    py=py_sum/sum_weight_;
-    pz=pz_sum/sum_weight_;
+    // Same order of the additions as summing up the stored solutions at the end
+    const double px=sum.px/sum_weight_;
+    const double py=sum.py/sum_weight_;
+    const double pz=sum.pz/sum_weight_;
     
     lv.SetXYZM(px,py,pz,mass);
 }
@@ -91,10 +89,27 @@ void KinematicReconstruction_MeanSol::getMeanVect(TLorentzVector& lv, const std:
 
 void KinematicReconstruction_MeanSol::getMeanSol(TLorentzVector& top, TLorentzVector& topbar, TLorentzVector& n, TLorentzVector& nbar)const
 {
-    this->getMeanVect(top,v_top_,mass_top_);
-    this->getMeanVect(topbar,v_topbar_,mass_top_);
-    this->getMeanVect(n,v_n_,0);
-    this->getMeanVect(nbar,v_nbar_,0);
+    this->getMeanVect(top,sum_top_,mass_top_);
+    this->getMeanVect(topbar,sum_topbar_,mass_top_);
+    this->getMeanVect(n,sum_n_,0);
+    this->getMeanVect(nbar,sum_nbar_,0);
+}
+
+
+
+void KinematicReconstruction_MeanSol::getMaxSol(TLorentzVector& top, TLorentzVector& topbar, TLorentzVector& n, TLorentzVector& nbar)const
+{
+    top = max_top_;
+    topbar = max_topbar_;
+    n = max_n_;
+    nbar = max_nbar_;
+}
+
+
+
+double KinematicReconstruction_MeanSol::getMaxWeight()const
+{
+    return max_weight_;
 }
 
 
@@ -110,7 +125,7 @@ double KinematicReconstruction_MeanSol::getSumWeight()const
 
 int KinematicReconstruction_MeanSol::getNsol()const
 {
-    return (int)v_top_.size();
+    return nsol_;
 }
 
 
@@ -122,10 +137,10 @@ void KinematicReconstruction_MeanSol::meanSolution(LV& top, LV& antiTop, LV& neu
     TLorentzVector neutrinoTemp = common::LVtoTLV(neutrino);
     TLorentzVector antiNeutrinoTemp = common::LVtoTLV(antiNeutrino);
     
-    this->getMeanVect(topTemp, v_top_, mass_top_);
-    this->getMeanVect(antiTopTemp, v_topbar_, mass_top_);
-    this->getMeanVect(neutrinoTemp, v_n_, 0);
-    this->getMeanVect(antiNeutrinoTemp, v_nbar_, 0);
+    this->getMeanVect(topTemp, sum_top_, mass_top_);
+    this->getMeanVect(antiTopTemp, sum_topbar_, mass_top_);
+    this->getMeanVect(neutrinoTemp, sum_n_, 0);
+    this->getMeanVect(antiNeutrinoTemp, sum_nbar_, 0);
     
     top = common::TLVtoLV(topTemp);
     antiTop = common::TLVtoLV(antiTopTemp);
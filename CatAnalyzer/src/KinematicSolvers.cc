@@ -4,7 +4,6 @@
 #include "FWCore/ParameterSet/interface/FileInPath.h"
 #include <gsl/gsl_multimin.h>
 #include <gsl/gsl_errno.h>
-#include "TFile.h"
 #include "TRandom3.h"
 
 using namespace cat;
@@ -246,28 +245,22 @@ DESYSmearedSolver::DESYSmearedSolver(const edm::ParameterSet& pset):
   KinematicSolver(pset),
   nTrial_(pset.getParameter<int>("nTrial")),
   maxLBMass_(pset.getParameter<double>("maxLBMass")),
-  mTopInput_(pset.getParameter<double>("mTopInput"))
+  mTopInput_(pset.getParameter<double>("mTopInput")),
+  useCounterBasedRandom_(pset.existsAs<bool>("counterBasedRandom") and pset.getParameter<bool>("counterBasedRandom"))
 {
   rng_ = 0;
+  randomKey_ = 0;
 
   const auto filePath = pset.getParameter<string>("inputTemplatePath");
-  TFile* f = TFile::Open(edm::FileInPath(filePath).fullPath().c_str());
-
-  h_jetEres_.reset(dynamic_cast<TH1*>(f->Get("KinReco_fE_jet_step7")));
-  h_jetAres_.reset(dynamic_cast<TH1*>(f->Get("KinReco_d_angle_jet_step7")));
-  h_lepEres_.reset(dynamic_cast<TH1*>(f->Get("KinReco_fE_lep_step7")));
-  h_lepAres_.reset(dynamic_cast<TH1*>(f->Get("KinReco_d_angle_lep_step7")));
-  h_wmass_.reset(dynamic_cast<TH1*>(f->Get("KinReco_W_mass_step0")));
-  h_mbl_w_.reset(dynamic_cast<TH1*>(f->Get("KinReco_mbl_true_step0")));
-
-  h_jetEres_->SetDirectory(0);
-  h_jetAres_->SetDirectory(0);
-  h_lepEres_->SetDirectory(0);
-  h_lepAres_->SetDirectory(0);
-  h_wmass_->SetDirectory(0);
-  h_mbl_w_->SetDirectory(0);
-
-  f->Close();
+  // Histograms are shared by all solvers reading the same file
+  inputs_ = KinRecoInputs::get(edm::FileInPath(filePath).fullPath());
+
+  h_jetEres_ = inputs_->jetEres();
+  h_jetAres_ = inputs_->jetAres();
+  h_lepEres_ = inputs_->lepEres();
+  h_lepAres_ = inputs_->lepAres();
+  h_wmass_ = inputs_->wmass();
+  h_mbl_w_ = inputs_->mbl_w();
 }
 
 void DESYSmearedSolver::solve(const LV input[])
@@ -290,17 +283,23 @@ void DESYSmearedSolver::solve(const LV input[])
   //const unsigned int seed = std::abs(static_cast<int>(1E6*j1.pt()/j2.pt() * sin(1E6*(l1.pt() + 2.*l2.pt()))));
   //gsl_rng_mt19937
   //gRandom->SetSeed(seed);
+  if ( useCounterBasedRandom_ ) {
+    // The trials are fixed by the event key, the kinematics of this combination and the trial number
+    const unsigned int seed = std::abs(static_cast<int>(1E6*j1.pt()/j2.pt() * sin(1E6*(l1.pt() + 2.*l2.pt()))));
+    counterRng_.setKey(randomKey_, seed);
+  }
   double sumW = 0;
   double sumP[6][3] = {{0,},};
   for ( int i=0; i<nTrial_; ++i )
   {
+    if ( useCounterBasedRandom_ ) counterRng_.setTrial(i);
     std::vector<double> koef, cache, sols;
 
     // Generate smearing factors for jets and leptons
-    const auto newl1 = getSmearedLV(l1, getRandom(h_lepEres_.get()), getRandom(h_lepAres_.get()));
-    const auto newl2 = getSmearedLV(l2, getRandom(h_lepEres_.get()), getRandom(h_lepAres_.get()));
-    const auto newj1 = getSmearedLV(j1, getRandom(h_jetEres_.get()), getRandom(h_jetAres_.get()));
-    const auto newj2 = getSmearedLV(j2, getRandom(h_jetEres_.get()), getRandom(h_jetAres_.get()));
+    const auto newl1 = getSmearedLV(l1, getRandom(h_lepEres_), getRandom(h_lepAres_));
+    const auto newl2 = getSmearedLV(l2, getRandom(h_lepEres_), getRandom(h_lepAres_));
+    const auto newj1 = getSmearedLV(j1, getRandom(h_jetEres_), getRandom(h_jetAres_));
+    const auto newj2 = getSmearedLV(j2, getRandom(h_jetEres_), getRandom(h_jetAres_));
     const double newl1E = newl1.E(), newl2E = newl2.E();
     const double newj1E = newj1.E(), newj2E = newj2.E();
     const double a4 = (newj2E*newl2.pz()-newl2E*newj2.pz())/newl2E/(newj2E+newl2E);
@@ -312,8 +311,8 @@ void DESYSmearedSolver::solve(const LV input[])
     const double newmetY = metY + visSum.py() - newVisSum.py();
 
     // Compute weight by m(B,L)
-    const double w1 = h_mbl_w_->GetBinContent(h_mbl_w_->FindBin((newl1+newj1).mass()));
-    const double w2 = h_mbl_w_->GetBinContent(h_mbl_w_->FindBin((newl2+newj2).mass()));
+    const double w1 = h_mbl_w_->GetBinContent(h_mbl_w_->FindFixBin((newl1+newj1).mass()));
+    const double w2 = h_mbl_w_->GetBinContent(h_mbl_w_->FindFixBin((newl2+newj2).mass()));
     double weight = w1*w2/h_mbl_w_->Integral()/h_mbl_w_->Integral();
     if ( weight <= 0 ) continue;
 
@@ -322,7 +321,7 @@ void DESYSmearedSolver::solve(const LV input[])
     KinSolverUtils::findCoeffs(mTopInput_, 80.4, 80.4,
                                newl1, newl2, newj1, newj2, newmetX, newmetY, koef, cache);
 #else
-    KinSolverUtils::findCoeffs(mTopInput_, getRandom(h_wmass_.get()), getRandom(h_wmass_.get()),
+    KinSolverUtils::findCoeffs(mTopInput_, getRandom(h_wmass_), getRandom(h_wmass_),
                                newl1, newl2, newj1, newj2, newmetX, newmetY, koef, cache);
 #endif
     KinSolverUtils::solve_quartic(koef, a4, b4, sols);
@@ -345,8 +344,8 @@ void DESYSmearedSolver::solve(const LV input[])
       const LV nu2(nu2solTmp[0], nu2solTmp[1], nu2solTmp[2], nu2solTmp[3]);
 
 /*
-      const double nw1 = h_mbl_w_->GetBinContent(h_mbl_w_->FindBin((nu1+newj1).mass()));
-      const double nw2 = h_mbl_w_->GetBinContent(h_mbl_w_->FindBin((nu2+newj2).mass()));
+      const double nw1 = h_mbl_w_->GetBinContent(h_mbl_w_->FindFixBin((nu1+newj1).mass()));
+      const double nw2 = h_mbl_w_->GetBinContent(h_mbl_w_->FindFixBin((nu2+newj2).mass()));
       const double nw = nw1*nw2/h_mbl_w_->Integral()/h_mbl_w_->Integral();
       if ( nw <= 0 ) continue;
 */
@@ -405,7 +404,7 @@ LV DESYSmearedSolver::getSmearedLV(const LV& lv0,
   if ( p == 0 ) return LV(0, 0, 0, e);
 
   // Apply rotation
-  const double localPhi = 2*TMath::Pi()*rng_->flat();
+  const double localPhi = 2*TMath::Pi()*flat();
   const double px1 = -p*sin(dRot)*sin(localPhi);
   const double py1 =  p*sin(dRot)*cos(localPhi);
   const double pz1 =  p*cos(dRot);
@@ -436,7 +435,7 @@ double DESYSmearedSolver::getRandom(TH1* h)
 
   if (integral == 0) return 0;
 
-  const double r1 = rng_->flat();
+  const double r1 = flat();
   const int ibin = TMath::BinarySearch(n, fIntegral, r1);
   double x = h->GetBinLowEdge(ibin+1);
   const double binW = h->GetBinWidth(ibin+1);
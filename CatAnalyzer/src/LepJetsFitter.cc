@@ -1,5 +1,8 @@
 #include "CATTools/CatAnalyzer/interface/LepJetsFitter.h"
 #include "CATTools/DataFormats/interface/Jet.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 using namespace cat;
 
@@ -101,7 +104,233 @@ Double_t ttbb::SolvettbarLepJets(Double_t &nupz, Double_t &metscale, Double_t &b
 }
 
 
-void ttbb::FindHadronicTop(TLorentzVector &lepton, std::vector<cat::ComJet> &jets, TLorentzVector &met, bool usebtaginfo, bool useCSVOrderinfo, std::vector<int> &bestindices, float &bestchi2, TLorentzVector &nusol, TLorentzVector &blrefit, TLorentzVector &bjrefit, TLorentzVector &j1refit, TLorentzVector &j2refit){
+namespace {
+
+inline double dot4(const double* a, const double* b) { return a[3]*b[3] - a[0]*b[0] - a[1]*b[1] - a[2]*b[2]; }
+
+// Mass residual r = (M-m0)/sigma of P with its derivatives, dP[k] is dP/dpar[k] or 0 if P does not depend on par[k].
+// M is negative for space-like P as in TLorentzVector::M(), dM/dpar = P.dP/|M| in both cases.
+// P is linear in the parameters, r times the second derivatives of r is added to curv.
+bool massResidual(const double P[4], const double m0, const double sigma, const double* const dP[6],
+                  double& r, double row[6], double curv[6][6]){
+  const double m2 = dot4(P, P);
+  const double absm = std::sqrt(std::abs(m2));
+  if ( !(absm > 1e-6) ) return false;
+
+  r = ((m2 < 0 ? -absm : absm) - m0)/sigma;
+  double pdp[6];
+  for ( int k = 0; k < 6; ++k ) {
+    pdp[k] = dP[k] ? dot4(P, dP[k]) : 0;
+    row[k] = pdp[k]/absm/sigma;
+  }
+  const double sign = m2 < 0 ? 1 : -1;
+  for ( int k = 0; k < 6; ++k ) {
+    if ( !dP[k] ) continue;
+    for ( int l = 0; l <= k; ++l ) {
+      if ( !dP[l] ) continue;
+      const double d2r = (dot4(dP[k], dP[l])/absm + sign*pdp[k]*pdp[l]/(absm*absm*absm))/sigma;
+      curv[k][l] += r*d2r;
+      if ( l != k ) curv[l][k] += r*d2r;
+    }
+  }
+  return true;
+}
+
+// Residuals of fcnfull, the chi2 is the sum of their squares, their derivatives
+// and the sum of the residuals times their second derivatives
+bool ttbbResiduals(const double par[6], double r[9], double jac[9][6], double curv[6][6]){
+  using namespace ttbb;
+
+  const double lep[4] = {tmplep.Px(), tmplep.Py(), tmplep.Pz(), tmplep.E()};
+  const double bl[4] = {tmpbl.Px(), tmpbl.Py(), tmpbl.Pz(), tmpbl.E()};
+  const double bj[4] = {tmpbj.Px(), tmpbj.Py(), tmpbj.Pz(), tmpbj.E()};
+  const double j1[4] = {tmpj1.Px(), tmpj1.Py(), tmpj1.Pz(), tmpj1.E()};
+  const double j2[4] = {tmpj2.Px(), tmpj2.Py(), tmpj2.Pz(), tmpj2.E()};
+  // As in fcnfull, the neutrino is tmpnu scaled by par[1] with its pz replaced by par[0], the energy is not recomputed
+  const double dnudpz[4] = {0, 0, 1, 0};
+  const double dnuds[4] = {tmpnu.Px(), tmpnu.Py(), 0, tmpnu.E()};
+
+  double wl[4], tl[4], wh[4], th[4];
+  for ( int i = 0; i < 4; ++i ) {
+    wl[i] = lep[i] + par[1]*dnuds[i] + par[0]*dnudpz[i];
+    tl[i] = wl[i] + par[2]*bl[i];
+    wh[i] = par[4]*j1[i] + par[5]*j2[i];
+    th[i] = wh[i] + par[3]*bj[i];
+  }
+
+  std::fill(&curv[0][0], &curv[0][0]+6*6, 0.);
+  const double* const dwl[6] = {dnudpz, dnuds, 0, 0, 0, 0};
+  const double* const dtl[6] = {dnudpz, dnuds, bl, 0, 0, 0};
+  const double* const dwh[6] = {0, 0, 0, 0, j1, j2};
+  const double* const dth[6] = {0, 0, 0, bj, j1, j2};
+  if ( !massResidual(wl, 80.4, 2.085, dwl, r[0], jac[0], curv) ) return false;
+  if ( !massResidual(tl, 172.0, 1.5, dtl, r[1], jac[1], curv) ) return false;
+  if ( !massResidual(wh, 80.4, 2.085, dwh, r[2], jac[2], curv) ) return false;
+  if ( !massResidual(th, 172.0, 1.5, dth, r[3], jac[3], curv) ) return false;
+
+  const float res[5] = {metres, blres, bjres, j1res, j2res};
+  for ( int k = 0; k < 5; ++k ) {
+    r[4+k] = (par[k+1]-1.0)/res[k];
+    for ( int l = 0; l < 6; ++l ) jac[4+k][l] = l == k+1 ? 1.0/res[k] : 0;
+  }
+
+  return true;
+}
+
+// Solve a.x = b for a symmetric positive definite 6x6 matrix
+bool choleskySolve(const double a[6][6], const double b[6], double x[6]){
+  double l[6][6];
+  for ( int i = 0; i < 6; ++i ) {
+    for ( int j = 0; j <= i; ++j ) {
+      double sum = a[i][j];
+      for ( int k = 0; k < j; ++k ) sum -= l[i][k]*l[j][k];
+      if ( i == j ) {
+        if ( !(sum > 0) ) return false;
+        l[i][i] = std::sqrt(sum);
+      }
+      else l[i][j] = sum/l[j][j];
+    }
+  }
+  for ( int i = 0; i < 6; ++i ) {
+    double sum = b[i];
+    for ( int k = 0; k < i; ++k ) sum -= l[i][k]*x[k];
+    x[i] = sum/l[i][i];
+  }
+  for ( int i = 5; i >= 0; --i ) {
+    double sum = x[i];
+    for ( int k = i+1; k < 6; ++k ) sum -= l[k][i]*x[k];
+    x[i] = sum/l[i][i];
+  }
+  return true;
+}
+
+// Levenberg-Marquardt minimisation of fcnfull from par, with the Gauss-Newton matrix JtJ.
+// Close to the minimum, where the full Hessian/2 = JtJ + sum r.d2r is positive definite, Newton steps are
+// taken instead since the mass residuals stay large for wrong permutations and Gauss-Newton converges slowly.
+// Converged when the estimated distance to the minimum, g.H^-1.g with g = Jt.r, is below edmMax as for MIGRAD.
+bool ttbbLevenbergMarquardt(double par[6], double &chi2){
+  constexpr int maxIterations = 100;
+  constexpr double edmMax = 1e-3;
+
+  double r[9], jac[9][6], curv[6][6];
+  if ( !ttbbResiduals(par, r, jac, curv) ) return false;
+  chi2 = 0;
+  for ( int k = 0; k < 9; ++k ) chi2 += r[k]*r[k];
+
+  double lambda = 1e-3;
+  for ( int iter = 0; iter < maxIterations; ++iter ) {
+    double a[6][6], h[6][6], g[6];
+    for ( int i = 0; i < 6; ++i ) {
+      g[i] = 0;
+      for ( int k = 0; k < 9; ++k ) g[i] += jac[k][i]*r[k];
+      for ( int j = 0; j <= i; ++j ) {
+        double sum = 0;
+        for ( int k = 0; k < 9; ++k ) sum += jac[k][i]*jac[k][j];
+        a[i][j] = a[j][i] = sum;
+        h[i][j] = h[j][i] = sum + curv[i][j];
+      }
+    }
+
+    // Newton step if the Hessian is positive definite, also gives the distance to the minimum
+    double step[6];
+    const bool isNewton = choleskySolve(h, g, step);
+    if ( isNewton ) {
+      double edm = 0;
+      for ( int i = 0; i < 6; ++i ) edm += g[i]*step[i];
+      if ( edm < edmMax ) return true;
+    }
+
+    // Damped steps until the chi2 decreases
+    while ( true ) {
+      double b[6][6];
+      for ( int i = 0; i < 6; ++i ) {
+        for ( int j = 0; j < 6; ++j ) b[i][j] = isNewton ? h[i][j] : a[i][j];
+        b[i][i] *= 1+lambda;
+      }
+      if ( !choleskySolve(b, g, step) ) return false;
+
+      double trial[6], rTrial[9], jacTrial[9][6], curvTrial[6][6];
+      for ( int i = 0; i < 6; ++i ) trial[i] = par[i] - step[i];
+      double chi2Trial = 0;
+      const bool isValid = ttbbResiduals(trial, rTrial, jacTrial, curvTrial);
+      if ( isValid ) for ( int k = 0; k < 9; ++k ) chi2Trial += rTrial[k]*rTrial[k];
+
+      if ( isValid and chi2Trial <= chi2 ) {
+        std::copy(trial, trial+6, par);
+        std::copy(rTrial, rTrial+9, r);
+        std::copy(&jacTrial[0][0], &jacTrial[0][0]+9*6, &jac[0][0]);
+        std::copy(&curvTrial[0][0], &curvTrial[0][0]+6*6, &curv[0][0]);
+        chi2 = chi2Trial;
+        lambda = std::max(lambda/10, 1e-9);
+        break;
+      }
+      lambda *= 10;
+      if ( lambda > 1e8 ) return false;
+    }
+  }
+
+  return false;
+}
+
+}
+
+Double_t ttbb::SolvettbarLepJetsGN(Double_t &nupz, Double_t &metscale, Double_t &blscale, Double_t &bjscale, Double_t &j1scale, Double_t &j2scale){
+
+  using namespace ttbb;
+
+  // Neutrino pz seeds from the W mass constraint with the unscaled objects, both roots are tried.
+  // The energy of the neutrino does not depend on pz in fcnfull.
+  const double px = tmplep.Px()+tmpnu.Px(), py = tmplep.Py()+tmpnu.Py(), e = tmplep.E()+tmpnu.E();
+  const double d = e*e - px*px - py*py - 80.4*80.4;
+  double seeds[2] = {-tmplep.Pz(), -tmplep.Pz()};
+  const int nSeeds = d > 0 ? 2 : 1;
+  if ( d > 0 ) { seeds[0] -= std::sqrt(d); seeds[1] += std::sqrt(d); }
+
+  bool isConverged = false;
+  double bestchi2 = 0, bestpar[6] = {0, 1, 1, 1, 1, 1};
+  for ( int i = 0; i < nSeeds; ++i ) {
+    double par[6] = {seeds[i], 1.0, 1.0, 1.0, 1.0, 1.0}, chi2;
+    if ( !ttbbLevenbergMarquardt(par, chi2) ) continue;
+    if ( isConverged and chi2 >= bestchi2 ) continue;
+    isConverged = true;
+    bestchi2 = chi2;
+    std::copy(par, par+6, bestpar);
+  }
+
+  // Fall back to MIGRAD
+  if ( !isConverged ) return SolvettbarLepJets(nupz, metscale, blscale, bjscale, j1scale, j2scale);
+
+  nupz     = bestpar[0];
+  metscale = bestpar[1];
+  blscale  = bestpar[2];
+  bjscale  = bestpar[3];
+  j1scale  = bestpar[4];
+  j2scale  = bestpar[5];
+
+  return bestchi2;
+}
+
+// Lower bound of the hadronic part of fcnfull, valid for any neutrino and scale factors.
+// For positive scale factors the scaled mass of a jet system lies between the smallest and
+// the largest scale times its mass, so each mass term and the prior of that jet together
+// cannot be lower than the 1D minimum (m0-M)^2/(sigma^2+M^2*res^2) with the largest resolution.
+// The W and top terms may use the same prior, only the larger of the two is a bound.
+// A non positive scale factor costs at least 1/res^2 from its prior alone.
+double ttbb::HadronicChi2LowerBound(const TLorentzVector &bj, const TLorentzVector &j1, const TLorentzVector &j2, float bjres, float j1res, float j2res){
+
+  if ( bj.M2() < 0 or j1.M2() < 0 or j2.M2() < 0 ) return 0;
+
+  const double wres = std::max(j1res, j2res);
+  const double topres = std::max<double>(bjres, wres);
+
+  const double mW = (j1+j2).M(), mTop = (bj+j1+j2).M();
+  const double chi2W = TMath::Power(mW-80.4, 2.0)/(TMath::Power(2.085, 2.0) + TMath::Power(mW*wres, 2.0));
+  const double chi2Top = TMath::Power(mTop-172.0, 2.0)/(TMath::Power(1.5, 2.0) + TMath::Power(mTop*topres, 2.0));
+
+  return std::min(std::max(chi2W, chi2Top), 1.0/(topres*topres));
+}
+
+void ttbb::FindHadronicTop(TLorentzVector &lepton, std::vector<cat::ComJet> &jets, TLorentzVector &met, bool usebtaginfo, bool useCSVOrderinfo, std::vector<int> &bestindices, float &bestchi2, TLorentzVector &nusol, TLorentzVector &blrefit, TLorentzVector &bjrefit, TLorentzVector &j1refit, TLorentzVector &j2refit, bool useGaussNewton){
 
   using namespace ttbb;
 
@@ -124,157 +353,130 @@ void ttbb::FindHadronicTop(TLorentzVector &lepton, std::vector<cat::ComJet> &jet
   // float wlmassrelres;
   // wlmassrelres = TwoObjectMassResolution(lepton, 0.0, nusol, 15.0/nusol.Pt());
   
+  // at least there should be 4 hadronic jets
+  if (njets<4) return;
+
+  // The jet resolutions depend on the jet only, compute them once and look them up in the permutations
+  std::vector<float> jetres(njets);
+  for (int i=0; i<njets; i++) jetres[i] = KinematicFitter::jetEResolution(jets[i].E());
+
+  // List the permutations to be fitted, in the order of the fits.
+  // The W jets are symmetric in the fit, only i2 < i3 is considered.
+  struct Permutation { int i1, i2, i3, i4; double chi2min; };
+  std::vector<Permutation> permutations;
+
   // not using b-tagging information
   if (!usebtaginfo){
-    // at least there should be 4 hadronic jets
-    if (njets>=4){
-      for (int i1=0; i1<njets; i1++){
-        for (int i2=0; i2<njets-1 ; i2++){
-          if ( i1 == i2 ) continue;
-          for (int i3=i2+1; i3<njets; i3++){
-            if ( i3 == i1 ) continue;
-            for (int i4=0; i4<njets; i4++){
-              if ( i4 == i1 or i4 == i2 or i4 == i3 ) continue;
-
-              trialb         = jets[i1];
-              trialWjet1     = jets[i2];
-              trialWjet2     = jets[i3];
-              trialW         = trialWjet1 + trialWjet2;
-              trialtop       = trialb + trialW;
-              trialblepton   = jets[i4];
-              trialtoplepton = trialwlepton + trialblepton;
-
-              // set global variables - ugly!
-              tmplep = lepton;
-              tmpnu  = nusol;
-              tmpbl  = trialblepton;
-              tmpbj  = trialb;
-              tmpj1  = trialWjet1;
-              tmpj2  = trialWjet2;
-
-              blres = KinematicFitter::jetEResolution(tmpbl.E());
-              bjres = KinematicFitter::jetEResolution(tmpbj.E());
-              j1res = KinematicFitter::jetEResolution(tmpj1.E());
-              j2res = KinematicFitter::jetEResolution(tmpj2.E());
-
-              double nupz, metscale, blscale, bjscale, j1scale, j2scale;
-
-              // dynamic resolutions
-              const double chi2 = SolvettbarLepJets(nupz, metscale, blscale, bjscale, j1scale, j2scale);
-
-              if(chi2 < bestchi2){
-                bestchi2 = chi2;
-                nusol = tmpnu*metscale;
-                nusol.SetPz(nupz);
-                blrefit = tmpbl*blscale;
-                bjrefit = tmpbj*bjscale;
-                j1refit = tmpj1*j1scale;
-                j2refit = tmpj2*j2scale;
-                bestidx1 = i1;
-                bestidx2 = i2;
-                bestidx3 = i3;
-                bestidx4 = i4;
-              }
-            }
+    for (int i1=0; i1<njets; i1++){
+      for (int i2=0; i2<njets-1 ; i2++){
+        if ( i1 == i2 ) continue;
+        for (int i3=i2+1; i3<njets; i3++){
+          if ( i3 == i1 ) continue;
+          for (int i4=0; i4<njets; i4++){
+            if ( i4 == i1 or i4 == i2 or i4 == i3 ) continue;
+            permutations.push_back({i1, i2, i3, i4, 0});
           }
         }
       }
-
-      bestindices[0]=bestidx1; // b for hadronic side
-      bestindices[1]=bestidx2; // W jet
-      bestindices[2]=bestidx3; // W jet
-      bestindices[3]=bestidx4; // b for leptonic side
     }
   }
 
   // use b-tagging information
   else {
-    // at least there should be 4 hadronic jets
-    if (njets>=4){
-      int nbjets=0;
-      for (int i1=0; i1<njets; i1++){
-        if (jets[i1].CSV > CSVWP) nbjets++;
-      }
+    int nbjets=0;
+    for (int i1=0; i1<njets; i1++){
+      if (jets[i1].CSV > CSVWP) nbjets++;
+    }
 
-      int bjCandidateIndex = njets;
-      if (useCSVOrderinfo){
-        bjCandidateIndex = 2;
-      }  
-
-      for (int i1 = 0; i1 < bjCandidateIndex; i1++){
-        for (int i2 = 0; i2 < njets-1; i2++){
-          if ( i2 == i1 ) continue;
-          for (int i3 = i2+1; i3 < njets; i3++){
-            if ( i3 == i1 ) continue;
-            for (int i4 = 0; i4 < bjCandidateIndex; i4++){
-
-              if ( i4==i1 or i4 == i2 or i4 == i3 ) continue;
-
-              //std::cout << i1 << " " << i2 << " " << i3 << " " << i4 << std::endl; 
-
-              if(((lepton + jets[i4]).M() < 170.0) &&
-                  ( nbjets==0 || // To be checked
-                    (nbjets==1 && (jets[i2].CSV < CSVWP && jets[i3].CSV < CSVWP)) ||
-                    (nbjets==2 && (jets[i2].CSV < CSVWP && jets[i3].CSV < CSVWP)) ||
-                    (nbjets==3 && (jets[i2].CSV < CSVWP || jets[i3].CSV < CSVWP)) ||
-                    (nbjets >3 && (jets[i2].CSV > CSVWP || jets[i3].CSV > CSVWP))
-                  )
-                ){
-
-                trialb            = jets[i1];
-                trialWjet1        = jets[i2];
-                trialWjet2        = jets[i3];
-                trialW            = trialWjet1 + trialWjet2;
-                trialtop          = trialb + trialW;
-                trialblepton      = jets[i4];
-                trialtoplepton    = trialwlepton + trialblepton;
-
-                // float bjetreleres;
-                // bjetreleres= KinematicFitter::jetEResolution(trialb.E());
-
-                // set global variables - ugly!
-                tmplep = lepton;
-                tmpnu  = nusol;
-                tmpbl  = trialblepton;
-                tmpbj  = trialb;
-                tmpj1  = trialWjet1;
-                tmpj2  = trialWjet2;
-
-                blres  = KinematicFitter::jetEResolution(tmpbl.E());
-                bjres  = KinematicFitter::jetEResolution(tmpbj.E());
-                j1res  = KinematicFitter::jetEResolution(tmpj1.E());
-                j2res  = KinematicFitter::jetEResolution(tmpj2.E());
-
-                double nupz, metscale, blscale, bjscale, j1scale, j2scale;
-
-                // dynamic resolutions
-                const double chi2 = SolvettbarLepJets(nupz, metscale, blscale, bjscale, j1scale, j2scale);
-
-                if (chi2 < bestchi2){
-                  bestchi2 = chi2;
-                  nusol = tmpnu*metscale;
-                  nusol.SetPz(nupz);
-                  blrefit = tmpbl*blscale;
-                  bjrefit = tmpbj*bjscale;
-                  j1refit = tmpj1*j1scale;
-                  j2refit = tmpj2*j2scale;
-                  bestidx1 = i1;
-                  bestidx2 = i2;
-                  bestidx3 = i3;
-                  bestidx4 = i4;		  
-                }
-              }
-            }
+    int bjCandidateIndex = njets;
+    if (useCSVOrderinfo){
+      bjCandidateIndex = 2;
+    }  
+
+    for (int i1 = 0; i1 < bjCandidateIndex; i1++){
+      for (int i2 = 0; i2 < njets-1; i2++){
+        if ( i2 == i1 ) continue;
+        for (int i3 = i2+1; i3 < njets; i3++){
+          if ( i3 == i1 ) continue;
+          // b-tag requirement on the W jets, depending on the number of b-tagged jets
+          if ( !( nbjets==0 || // To be checked
+                  (nbjets==1 && (jets[i2].CSV < CSVWP && jets[i3].CSV < CSVWP)) ||
+                  (nbjets==2 && (jets[i2].CSV < CSVWP && jets[i3].CSV < CSVWP)) ||
+                  (nbjets==3 && (jets[i2].CSV < CSVWP || jets[i3].CSV < CSVWP)) ||
+                  (nbjets >3 && (jets[i2].CSV > CSVWP || jets[i3].CSV > CSVWP)) ) ) continue;
+          for (int i4 = 0; i4 < bjCandidateIndex; i4++){
+            if ( i4==i1 or i4 == i2 or i4 == i3 ) continue;
+            if ( (lepton + jets[i4]).M() >= 170.0 ) continue;
+
+            //std::cout << i1 << " " << i2 << " " << i3 << " " << i4 << std::endl; 
+
+            permutations.push_back({i1, i2, i3, i4, 0});
           }
         }
       }
+    }
+  }
 
-      bestindices[0]=bestidx1; // b for hadronic side
-      bestindices[1]=bestidx2; // W jet
-      bestindices[2]=bestidx3; // W jet
-      bestindices[3]=bestidx4; // b for leptonic side
+  // A permutation whose lower bound is not below the best chi2 cannot be chosen, its fit is skipped.
+  // Stop once this holds for all the remaining permutations.
+  const int nperm = permutations.size();
+  std::vector<double> remainingchi2min(nperm+1, std::numeric_limits<double>::infinity());
+  for (int i = nperm-1; i >= 0; --i){
+    auto& p = permutations[i];
+    p.chi2min = HadronicChi2LowerBound(jets[p.i1], jets[p.i2], jets[p.i3], jetres[p.i1], jetres[p.i2], jetres[p.i3]);
+    remainingchi2min[i] = std::min(remainingchi2min[i+1], p.chi2min);
+  }
+
+  for (int i = 0; i < nperm; i++){
+    if ( remainingchi2min[i] >= bestchi2 ) break;
+    const auto& p = permutations[i];
+    if ( p.chi2min >= bestchi2 ) continue;
+
+    trialb         = jets[p.i1];
+    trialWjet1     = jets[p.i2];
+    trialWjet2     = jets[p.i3];
+    trialW         = trialWjet1 + trialWjet2;
+    trialtop       = trialb + trialW;
+    trialblepton   = jets[p.i4];
+    trialtoplepton = trialwlepton + trialblepton;
+
+    // set global variables - ugly!
+    tmplep = lepton;
+    tmpnu  = nusol;
+    tmpbl  = trialblepton;
+    tmpbj  = trialb;
+    tmpj1  = trialWjet1;
+    tmpj2  = trialWjet2;
+
+    blres = jetres[p.i4];
+    bjres = jetres[p.i1];
+    j1res = jetres[p.i2];
+    j2res = jetres[p.i3];
+
+    double nupz, metscale, blscale, bjscale, j1scale, j2scale;
+
+    // dynamic resolutions
+    const double chi2 = useGaussNewton ? SolvettbarLepJetsGN(nupz, metscale, blscale, bjscale, j1scale, j2scale)
+                                       : SolvettbarLepJets(nupz, metscale, blscale, bjscale, j1scale, j2scale);
+
+    if(chi2 < bestchi2){
+      bestchi2 = chi2;
+      nusol = tmpnu*metscale;
+      nusol.SetPz(nupz);
+      blrefit = tmpbl*blscale;
+      bjrefit = tmpbj*bjscale;
+      j1refit = tmpj1*j1scale;
+      j2refit = tmpj2*j2scale;
+      bestidx1 = p.i1;
+      bestidx2 = p.i2;
+      bestidx3 = p.i3;
+      bestidx4 = p.i4;
     }
   }
+
+  bestindices[0]=bestidx1; // b for hadronic side
+  bestindices[1]=bestidx2; // W jet
+  bestindices[2]=bestidx3; // W jet
+  bestindices[3]=bestidx4; // b for leptonic side
   
 }
-
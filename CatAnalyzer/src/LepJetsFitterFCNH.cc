@@ -129,6 +129,10 @@ void fcnh::FindHadronicTop(TLorentzVector &lepton, std::vector<cat::Jet> &jets,
   // float wlmassrelres;
   // wlmassrelres = KinematicFitter::twoObjectMassResolution(lepton, 0.0, nusol, 15.0/nusol.Pt());
 
+  // The jet resolutions depend on the jet only, compute them once and look them up in the permutations
+  std::vector<float> jetres(njets);
+  for (int i=0; i<njets; i++) jetres[i] = KinematicFitter::jetEResolution(jets[i].tlv().E());
+
   // not using b-tagging information
   if (!usebtaginfo){
     // at least there should be 4 hadronic jets
@@ -156,10 +160,10 @@ void fcnh::FindHadronicTop(TLorentzVector &lepton, std::vector<cat::Jet> &jets,
                 tmpj1  = trialWjet1;
                 tmpj2  = trialWjet2;
 
-                blres = KinematicFitter::jetEResolution(tmpbl.E());
-                bjres = KinematicFitter::jetEResolution(tmpbj.E());
-                j1res = KinematicFitter::jetEResolution(tmpj1.E());
-                j2res = KinematicFitter::jetEResolution(tmpj2.E());
+                blres = jetres[i4];
+                bjres = jetres[i1];
+                j1res = jetres[i2];
+                j2res = jetres[i3];
 
                 double nupz, metscale, blscale, bjscale, j1scale, j2scale;
 
@@ -241,10 +245,10 @@ void fcnh::FindHadronicTop(TLorentzVector &lepton, std::vector<cat::Jet> &jets,
                   tmpj1  = trialWjet1;
                   tmpj2  = trialWjet2;
 
-                  blres  = KinematicFitter::jetEResolution(tmpbl.E());
-                  bjres  = KinematicFitter::jetEResolution(tmpbj.E());
-                  j1res  = KinematicFitter::jetEResolution(tmpj1.E());
-                  j2res  = KinematicFitter::jetEResolution(tmpj2.E());
+                  blres  = jetres[i4];
+                  bjres  = jetres[i1];
+                  j1res  = jetres[i2];
+                  j2res  = jetres[i3];
 
 
                   double nupz, metscale, blscale, bjscale, j1scale, j2scale;
@@ -4,10 +4,44 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <algorithm>
+#include <cstdio>
 #include "TSystem.h"
 #include "TMath.h"
 #include "RoccoR.h"
 
+namespace {
+    // Raw dump of fixed-size members, used for the binary cache
+    template<class T> void writeRaw(std::ostream& out, const T& x){
+	out.write(reinterpret_cast<const char*>(&x), sizeof(T));
+    }
+    template<class T> void readRaw(std::istream& in, T& x){
+	in.read(reinterpret_cast<char*>(&x), sizeof(T));
+    }
+
+    // FNV-1a of the name, size and modification time of a file, used to detect stale binary caches
+    void hashBytes(const void* p, size_t n, unsigned long long& sum){
+	for(size_t i=0; i<n; ++i){
+	    sum ^= ((const unsigned char*)p)[i];
+	    sum *= 1099511628211ULL;
+	}
+    }
+    void hashFileStat(std::string filename, unsigned long long& sum){
+	long long stat[2] = {-1, -1};
+	FileStat_t st;
+	if(gSystem->GetPathInfo(filename.c_str(), st)==0){
+	    stat[0]=st.fSize;
+	    stat[1]=st.fMtime;
+	}
+	hashBytes(filename.c_str(), filename.size(), sum);
+	hashBytes(stat, sizeof(stat), sum);
+    }
+
+    const char ROCCACHEMAGIC[8] = {'R','O','C','C','O','R','B','1'};
+}
+
+
+const double RocRes::TABNSIGMA=3.0;
 
 int RocRes::getBin(double x, const int NN, const double *b) const{
     for(int i=0; i<NN; ++i) if(x<b[i+1]) return i;
@@ -22,6 +56,9 @@ void RocRes::reset(){
     NETA=1;
     NTRK=1;
     NMIN=1;
+    NGRID=0;
+    cbTable.clear();
+    cbRange.clear();
     for(int H=0; H<NMAXETA; ++H){
 	BETA[H]=0;
 	kDat[H]=1.0;
@@ -38,10 +75,11 @@ void RocRes::reset(){
 	}
     }
     BETA[NMAXETA]=0;
+    etaLookup.init(NETA, BETA);
 }
 
 int RocRes::getEtaBin(double feta) const{
-    return getBin(feta,NETA,BETA);
+    return etaLookup.find(feta,BETA);
 }
 
 int RocRes::getNBinDT(double v, int H) const{
@@ -85,7 +123,7 @@ void RocRes::dumpParams(){
 	
 void RocRes::init(std::string filename){
     std::ifstream in(filename.c_str());
-    char tag[4];
+    std::string tag;
     int type, sys, mem, isdt, var, bin;	
     std::string s;
     while(std::getline(in, s)){
@@ -127,9 +165,60 @@ void RocRes::init(std::string filename){
 	    cb[H][F].init(0.0, width[H][F], alpha[H][F], power[H][F]);
 	}
     }
+    etaLookup.init(NETA, BETA);
     in.close();
 }
 
+void RocRes::write(std::ostream& out) const{
+    writeRaw(out, NETA); writeRaw(out, NTRK); writeRaw(out, NMIN);
+    writeRaw(out, BETA); writeRaw(out, ntrk); writeRaw(out, dtrk);
+    writeRaw(out, width); writeRaw(out, alpha); writeRaw(out, power);
+    writeRaw(out, rmsA); writeRaw(out, rmsB); writeRaw(out, rmsC);
+    writeRaw(out, kDat); writeRaw(out, kRes);
+    writeRaw(out, cb);
+}
+
+void RocRes::read(std::istream& in){
+    readRaw(in, NETA); readRaw(in, NTRK); readRaw(in, NMIN);
+    readRaw(in, BETA); readRaw(in, ntrk); readRaw(in, dtrk);
+    readRaw(in, width); readRaw(in, alpha); readRaw(in, power);
+    readRaw(in, rmsA); readRaw(in, rmsB); readRaw(in, rmsC);
+    readRaw(in, kDat); readRaw(in, kRes);
+    readRaw(in, cb);
+    etaLookup.init(NETA, BETA);
+    NGRID=0;
+    cbTable.clear();
+    cbRange.clear();
+}
+
+void RocRes::tabulate(int ngrid){
+    NGRID=ngrid;
+    cbTable.assign(NMAXETA*NMAXTRK*(NGRID+1), 0.0);
+    cbRange.assign(NMAXETA*NMAXTRK*2, 0.0);
+    for(int H=0; H<NETA; ++H){
+	for(int F=0; F<NTRK; ++F){
+	    // Tabulate within +-TABNSIGMA only, the inverse CDF is too steep outside
+	    const CrystalBall& c=cb[H][F];
+	    const double ulo=c.cdf(c.m-TABNSIGMA*c.s), uhi=c.cdf(c.m+TABNSIGMA*c.s);
+	    double *r=&cbRange[(H*NMAXTRK+F)*2];
+	    r[0]=ulo;
+	    r[1]=NGRID/(uhi-ulo);
+	    double *t=&cbTable[(H*NMAXTRK+F)*(NGRID+1)];
+	    for(int i=0; i<=NGRID; ++i) t[i]=c.invcdf(ulo+(uhi-ulo)*i/NGRID);
+	}
+    }
+}
+
+double RocRes::invcdf(int H, int F, double u) const{
+    if(NGRID==0) return cb[H][F].invcdf(u);
+    const double *r=&cbRange[(H*NMAXTRK+F)*2];
+    const double x=(u-r[0])*r[1];
+    if(x<0 || x>=NGRID) return cb[H][F].invcdf(u);
+    const int i=x;
+    const double *t=&cbTable[(H*NMAXTRK+F)*(NGRID+1)];
+    return t[i]+(t[i+1]-t[i])*(x-i);
+}
+
 double RocRes::Sigma(double pt, int H, int F) const{
     double dpt=pt-45;
     return rmsA[H][F] + rmsB[H][F]*dpt + rmsC[H][F]*dpt*dpt;
@@ -140,43 +229,43 @@ double RocRes::getUrnd(int H, int F, double w) const{
 }
 
 double RocRes::kSpread(double gpt, double rpt, double eta, int n, double w) const{
-    int     H = getBin(fabs(eta), NETA, BETA);
+    int     H = getEtaBin(fabs(eta));
     int     F = n>NMIN ? n-NMIN : 0;
     double  v = getUrnd(H, F, w);
     int     D = getBin(v, NTRK, dtrk[H]);
     double  kold = gpt / rpt;
     double  u = cb[H][F].cdf( (kold-1.0)/kRes[H]/Sigma(gpt,H,F) ); 
-    double  knew = 1.0 + kDat[H]*Sigma(gpt,H,D)*cb[H][D].invcdf(u);
+    double  knew = 1.0 + kDat[H]*Sigma(gpt,H,D)*invcdf(H, D, u);
     if(knew<0) return 1.0;
     return kold/knew;
 }
 
 double RocRes::kSmear(double pt, double eta, TYPE type, double v, double u) const{
-    int H = getBin(fabs(eta), NETA, BETA);
+    int H = getEtaBin(fabs(eta));
     int F = type==Data? getNBinDT(v, H) : getNBinMC(v, H);
     double K = type==Data ? kDat[H] : kRes[H]; 
-    double x = K*Sigma(pt, H, F)*cb[H][F].invcdf(u);
+    double x = K*Sigma(pt, H, F)*invcdf(H, F, u);
     return 1.0/(1.0+x);
 }
 
 double RocRes::kSmear(double pt, double eta, TYPE type, double w, double u, int n) const{
-    int H = getBin(fabs(eta), NETA, BETA);
+    int H = getEtaBin(fabs(eta));
     int F = n>NMIN ? n-NMIN : 0;
     if(type==Data) F = getNBinDT(getUrnd(H, F, w), H);
     double K = type==Data ? kDat[H] : kRes[H]; 
-    double x = K*Sigma(pt, H, F)*cb[H][F].invcdf(u);
+    double x = K*Sigma(pt, H, F)*invcdf(H, F, u);
     return 1.0/(1.0+x);
 }
 
 double RocRes::kExtra(double pt, double eta, int n, double u, double w) const{
-    int H = getBin(fabs(eta), NETA, BETA);
+    int H = getEtaBin(fabs(eta));
     int F = n>NMIN ? n-NMIN : 0;
     double  v = ntrk[H][F]+(ntrk[H][F+1]-ntrk[H][F])*w;
     int     D = getBin(v, NTRK, dtrk[H]);
     double RD = kDat[H]*Sigma(pt, H, D);
     double RM = kRes[H]*Sigma(pt, H, F);
     if(RD<=RM) return 1.0; 
-    double r=cb[H][F].invcdf(u);
+    double r=invcdf(H, F, u);
     if(fabs(r)>5) return 1.0; //protection against too large smearing
     double x = sqrt(RD*RD-RM*RM)*r;
     if(x<=-1) return 1.0;
@@ -240,6 +329,7 @@ void RocOne::reset(){
 	}
     }
     BETA[NMAXETA]=0;
+    etaLookup.init(NETA, BETA);
 }
 
 void RocOne::init(std::string filename, int iTYPE, int iSYS, int iMEM){
@@ -249,7 +339,7 @@ void RocOne::init(std::string filename, int iTYPE, int iSYS, int iMEM){
     RR.init(filename);
 
     std::ifstream in(filename.c_str());
-    char tag[4];
+    std::string tag;
     int type, sys, mem, isdt, var, bin;	
 
     bool initialized=false;
@@ -264,6 +354,7 @@ void RocOne::init(std::string filename, int iTYPE, int iSYS, int iMEM){
 	else if(s.substr(0,4)=="CETA")  {
 	    ss >> tag >> NETA;
 	    for(int i=0; i< NETA+1; ++i) ss >> BETA[i];
+	    etaLookup.init(NETA, BETA);
 	}
 	else if(s.substr(0,1)=="C")  {
 	    ss >> tag >> type >> sys >> mem >> isdt >> var >> bin; 
@@ -288,8 +379,23 @@ void RocOne::init(std::string filename, int iTYPE, int iSYS, int iMEM){
     in.close();
 }
 
+void RocOne::write(std::ostream& out) const{
+    writeRaw(out, NETA); writeRaw(out, NPHI);
+    writeRaw(out, BETA); writeRaw(out, DPHI);
+    writeRaw(out, M); writeRaw(out, A); writeRaw(out, D);
+    RR.write(out);
+}
+
+void RocOne::read(std::istream& in){
+    readRaw(in, NETA); readRaw(in, NPHI);
+    readRaw(in, BETA); readRaw(in, DPHI);
+    readRaw(in, M); readRaw(in, A); readRaw(in, D);
+    RR.read(in);
+    etaLookup.init(NETA, BETA);
+}
+
 double RocOne::kScaleDT(int Q, double pt, double eta, double phi) const{
-    int H=getBin(eta, NETA, BETA);
+    int H=etaLookup.find(eta, BETA);
     int F=getBin(phi, NPHI, MPHI, DPHI);
     double m=M[DT][H][F];
     double a=A[DT][H][F];
@@ -301,7 +407,7 @@ double RocOne::kScaleDT(int Q, double pt, double eta, double phi) const{
 
 
 double RocOne::kScaleMC(int Q, double pt, double eta, double phi, double kSMR) const{
-    int H=getBin(eta, NETA, BETA);
+    int H=etaLookup.find(eta, BETA);
     int F=getBin(phi, NPHI, MPHI, DPHI);
     double m=M[MC][H][F];
     double a=A[MC][H][F];
@@ -336,6 +442,104 @@ RoccoR::RoccoR(std::string dirname){
     init(dirname);
 }
 
+RoccoR::RoccoR(std::string dirname, std::string cachename){
+    init(dirname, cachename);
+}
+
+void
+RoccoR::init(std::string dirname, std::string cachename){
+    const unsigned long long key = inputKey(dirname);
+    if(readCache(cachename, key)) return;
+
+    std::cout << "RoccoR: binary cache " << cachename << " is missing or stale, reading text files..." << std::endl;
+    RC.clear();
+    init(dirname);
+    if(!writeCache(cachename, key)) std::cout << "RoccoR: cannot write binary cache " << cachename << std::endl;
+}
+
+unsigned long long
+RoccoR::inputKey(std::string dirname){
+    unsigned long long sum = 14695981039346656037ULL;
+
+    std::string filename=Form("%s/config.txt", dirname.c_str());
+    hashFileStat(filename, sum);
+
+    // Follow the same file lookup as init(), including the fallback to the default set
+    std::ifstream in(filename.c_str());
+    std::string s;
+    std::string tag;
+    int si;
+    int sn;
+    while(std::getline(in, s)){
+	std::stringstream ss(s); 
+	ss >> tag >> si >> sn; 
+	for(int m=0; m<sn; ++m){
+	    std::string inputfile=Form("%s/%d.%d.txt", dirname.c_str(), si, m);
+	    if(gSystem->AccessPathName(inputfile.c_str())) inputfile=Form("%s/%d.%d.txt", dirname.c_str(), 0, 0);
+	    hashFileStat(inputfile, sum);
+	}
+    }
+    in.close();
+
+    return sum;
+}
+
+bool
+RoccoR::readCache(std::string cachename, unsigned long long key){
+    std::ifstream in(cachename.c_str(), std::ios::binary);
+    if(!in) return false;
+
+    char magic[8];
+    unsigned long long fsum=0, fsize=0;
+    in.read(magic, sizeof(magic));
+    readRaw(in, fsum);
+    readRaw(in, fsize);
+    if(!in || !std::equal(magic, magic+8, ROCCACHEMAGIC)) return false;
+    if(fsum!=key || fsize!=sizeof(RocOne)) return false;
+
+    int nset=0;
+    readRaw(in, nset);
+    std::vector<std::vector<RocOne> > rc(nset);
+    for(int i=0; i<nset && in; ++i){
+	int nmem=0;
+	readRaw(in, nmem);
+	rc[i].resize(nmem);
+	for(int m=0; m<nmem; ++m) rc[i][m].read(in);
+    }
+    if(!in) return false;
+
+    RC.swap(rc);
+    return true;
+}
+
+bool
+RoccoR::writeCache(std::string cachename, unsigned long long key) const{
+    // Written under a temporary name and renamed when complete, so that jobs sharing
+    // the release area never read a partially written cache
+    const std::string tmpname=Form("%s.%s.%d.tmp", cachename.c_str(), gSystem->HostName(), gSystem->GetPid());
+    std::ofstream out(tmpname.c_str(), std::ios::binary);
+    if(!out) return false;
+
+    const unsigned long long size=sizeof(RocOne);
+    out.write(ROCCACHEMAGIC, sizeof(ROCCACHEMAGIC));
+    writeRaw(out, key);
+    writeRaw(out, size);
+
+    const int nset=RC.size();
+    writeRaw(out, nset);
+    for(int i=0; i<nset; ++i){
+	const int nmem=RC[i].size();
+	writeRaw(out, nmem);
+	for(int m=0; m<nmem; ++m) RC[i][m].write(out);
+    }
+    out.close();
+    if(!out || std::rename(tmpname.c_str(), cachename.c_str())!=0){
+	std::remove(tmpname.c_str());
+	return false;
+    }
+    return true;
+}
+
 
 void 
 RoccoR::init(std::string dirname){
@@ -387,6 +591,27 @@ double RoccoR::kScaleFromGenMC(int Q, double pt, double eta, double phi, int n,
     return RC[s][m].kScaleFromGenMC(Q, pt, eta, phi, n, gt, w);
 }
 
+void RoccoR::kScaleDT(int N, const int *Q, const double *pt, const double *eta, const double *phi, double *k, int s, int m) const{
+    const RocOne& rc=RC[s][m];
+    for(int i=0; i<N; ++i) k[i]=rc.kScaleDT(Q[i], pt[i], eta[i], phi[i]);
+}
+
+void RoccoR::kScaleAndSmearMC(int N, const int *Q, const double *pt, const double *eta, const double *phi, const int *n, const double *u, const double *w, double *k, int s, int m) const{
+    const RocOne& rc=RC[s][m];
+    for(int i=0; i<N; ++i) k[i]=rc.kScaleAndSmearMC(Q[i], pt[i], eta[i], phi[i], n[i], u[i], w[i]);
+}
+
+void RoccoR::kScaleFromGenMC(int N, const int *Q, const double *pt, const double *eta, const double *phi, const int *n, const double *gt, const double *w, double *k, int s, int m) const{
+    const RocOne& rc=RC[s][m];
+    for(int i=0; i<N; ++i) k[i]=rc.kScaleFromGenMC(Q[i], pt[i], eta[i], phi[i], n[i], gt[i], w[i]);
+}
+
+void RoccoR::tabulate(int ngrid){
+    for(auto& v : RC){
+	for(auto& rc : v) rc.getR().tabulate(ngrid);
+    }
+}
+
 
 #endif
 
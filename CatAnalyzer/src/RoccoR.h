@@ -1,3 +1,5 @@
+#include <string>
+#include <vector>
 #include "TRandom3.h"
 #include "TMath.h"
 
@@ -94,6 +96,44 @@ const double CrystalBall::SPiO2 = sqrt(TMath::Pi()/2.0);
 const double CrystalBall::S2    = sqrt(2.0);
 
 
+// Direct-indexed bin search for non-uniform bins: a uniform grid over the bin
+// range gives the lowest candidate bin, refined by a step or two.
+// Returns the same bin as the linear search in RocRes/RocOne::getBin.
+struct RocBinLookup{
+    static const int NCELL=256;
+
+    int NN;
+    double xmin;
+    double dx;
+    int start[NCELL];
+
+    RocBinLookup(){ NN=1; xmin=0; dx=0; }
+
+    void init(const int NN_, const double *b){
+	NN=NN_;
+	xmin=b[0];
+	dx=(b[NN]-b[0])/NCELL;
+	for(int c=0; c<NCELL; ++c){
+	    start[c]=0;
+	    if(dx<=0) continue;
+	    const double x=xmin+c*dx;
+	    while(start[c]<NN-1 && x>=b[start[c]+1]) ++start[c];
+	    if(start[c]>0) --start[c]; // protect against rounding at the cell edge
+	}
+    }
+
+    int find(double x, const double *b) const{
+	int i=0;
+	if(dx>0 && x>xmin){
+	    const double c=(x-xmin)/dx;
+	    i = c<NCELL ? start[int(c)] : start[NCELL-1];
+	}
+	for(; i<NN; ++i) if(x<b[i+1]) return i;
+	return NN-1;
+    }
+};
+
+
 class RocRes{
     private:
 	static const int NMAXETA=12;
@@ -118,7 +158,15 @@ class RocRes{
 	double kDat[NMAXETA];
 	double kRes[NMAXETA];
 
+	RocBinLookup etaLookup;
+
+	static const double TABNSIGMA;
+	int NGRID;
+	std::vector<double> cbTable; // inverse CDF of cb[H][F] on NGRID+1 points in u, see tabulate()
+	std::vector<double> cbRange; // lower edge and inverse step of each table in u
+
 	int getBin(double x, const int NN, const double *b) const;
+	double invcdf(int H, int F, double u) const;
 
 
     public:
@@ -133,6 +181,9 @@ class RocRes{
 	double getUrnd(int H, int F, double v) const;
 	void dumpParams();
 	void init(std::string filename);
+	void write(std::ostream& out) const;
+	void read(std::istream& in);
+	void tabulate(int ngrid);
 
 	void reset();
 
@@ -166,6 +217,8 @@ class RocOne{
 
 	RocRes RR;
 
+	RocBinLookup etaLookup;
+
 	int getBin(double x, const int NN, const double *b) const;
 	int getBin(double x, const int nmax, const double xmin, const double dx) const;
 
@@ -180,6 +233,8 @@ class RocOne{
 	bool checkTIGHT(int iTYPE, int iSYS, int iMEM, int kTYPE=0, int kSYS=0, int kMEM=0);
 	void reset();
 	void init(std::string filename, int iTYPE=0, int iSYS=0, int iMEM=0);
+	void write(std::ostream& out) const;
+	void read(std::istream& in);
 
 	double kScaleDT(int Q, double pt, double eta, double phi) const;
 	double kScaleMC(int Q, double pt, double eta, double phi, double kSMR=1) const;
@@ -198,9 +253,18 @@ class RoccoR{
     public:
 	RoccoR(); 
 	RoccoR(std::string dirname); 
+	RoccoR(std::string dirname, std::string cachename); 
 	~RoccoR();
 
 	void init(std::string dirname);
+	// Load from a binary cache, falling back to (and regenerating it from) the text files if stale
+	void init(std::string dirname, std::string cachename);
+
+	bool readCache(std::string cachename, unsigned long long key);
+	bool writeCache(std::string cachename, unsigned long long key) const;
+	// Key of the text inputs from the names, sizes and modification times of config.txt
+	// and the correction files, without reading the correction files
+	static unsigned long long inputKey(std::string dirname);
 
 	double kGenSmear(double pt, double eta, double v, double u, RocRes::TYPE TT=RocRes::Data, int s=0, int m=0) const;
 	double kScaleDT(int Q, double pt, double eta, double phi, int s=0, int m=0) const;
@@ -208,6 +272,16 @@ class RoccoR{
 	double kScaleAndSmearMC(int Q, double pt, double eta, double phi, int n, double u, double w, int s=0, int m=0) const;  
 	double kScaleFromGenMC(int Q, double pt, double eta, double phi, int n, double gt, double w, int s=0, int m=0) const; 
 
+	// Batch versions for all N muons of an event, corrections are written to k[0..N-1]
+	void kScaleDT(int N, const int *Q, const double *pt, const double *eta, const double *phi, double *k, int s=0, int m=0) const;
+	void kScaleAndSmearMC(int N, const int *Q, const double *pt, const double *eta, const double *phi, const int *n, const double *u, const double *w, double *k, int s=0, int m=0) const;
+	void kScaleFromGenMC(int N, const int *Q, const double *pt, const double *eta, const double *phi, const int *n, const double *gt, const double *w, double *k, int s=0, int m=0) const;
+
+	// Replace the analytic CrystalBall inverse CDF by linear interpolation on ngrid
+	// points within +-3 sigma in all sets, the tails keep the analytic form.
+	// The deviation is below 2e-4 (ngrid=4096) in units of the resolution.
+	void tabulate(int ngrid=4096);
+
 
 	double getM(int T, int H, int F, int E=0, int m=0) const{return RC[E][m].getM(T,H,F);}
 	double getA(int T, int H, int F, int E=0, int m=0) const{return RC[E][m].getA(T,H,F);}
@@ -0,0 +1,81 @@
+#ifndef CATTools_CatAnalyzer_RoccoRTestInputs_H
+#define CATTools_CatAnalyzer_RoccoRTestInputs_H
+
+// Synthetic RoccoR correction set in the rcdata text format, for the standalone tests.
+// Set 0 has one member, set 1 has two members of which 1.1 is missing (default set used instead).
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <random>
+
+namespace RoccoRTest {
+
+inline void writeCorrectionFile(const std::string& filename, int sys, int mem, unsigned seed)
+{
+  std::mt19937 rnd(seed);
+  auto flat = [&](double a, double b) { return std::uniform_real_distribution<double>(a, b)(rnd); };
+
+  const int NTRK = 5, NRETA = 3, NPHI = 16, NCETA = 8;
+  FILE* f = fopen(filename.c_str(), "w");
+  fprintf(f, "RMIN 6\nRTRK %d\nRETA %d 0 0.9 1.5 2.4\n", NTRK, NRETA);
+  for ( int bin = 0; bin < NRETA; ++bin ) {
+    const double lo[6] = {0.010, 1.0e-4, 1.0e-4, 1.00, 1.50, 3.0}; // rmsA, rmsB, rmsC (x100), width, alpha, power
+    const double hi[6] = {0.011, 1.1e-4, 1.1e-4, 1.10, 1.65, 3.3};
+    for ( int var = 0; var < 6; ++var ) {
+      fprintf(f, "R 0 %d %d 0 %d %d", sys, mem, var, bin);
+      for ( int i = 0; i < NTRK; ++i ) fprintf(f, " %.9g", flat(lo[var], hi[var]));
+      fprintf(f, "\n");
+    }
+    for ( int isdt = 0; isdt < 2; ++isdt ) {
+      fprintf(f, "T 0 %d %d %d 0 %d 0", sys, mem, isdt, bin);
+      for ( int i = 1; i < NTRK; ++i ) fprintf(f, " %.9g", (i+flat(-0.3, 0.3))/NTRK);
+      fprintf(f, " 1\n");
+    }
+  }
+  for ( int isdt = 0; isdt < 2; ++isdt ) {
+    fprintf(f, "F 0 %d %d %d 0 0", sys, mem, isdt);
+    for ( int i = 0; i < NRETA; ++i ) fprintf(f, " %.9g", flat(1.0, 1.2));
+    fprintf(f, "\n");
+  }
+
+  fprintf(f, "CPHI %d\nCETA %d -2.4 -2.1 -1.2 -0.9 0 0.9 1.2 2.1 2.4\n", NPHI, NCETA);
+  for ( int isdt = 0; isdt < 2; ++isdt ) {
+    for ( int bin = 0; bin < NCETA; ++bin ) {
+      for ( int var = 0; var < 2; ++var ) {
+        fprintf(f, "C 0 %d %d %d %d %d", sys, mem, isdt, var, bin);
+        for ( int i = 0; i < NPHI; ++i ) fprintf(f, " %.9g", var == 0 ? flat(-1, 1) : flat(-0.01, 0.01));
+        fprintf(f, "\n");
+      }
+    }
+    fprintf(f, "F 0 %d %d %d 1 0", sys, mem, isdt);
+    for ( int i = 0; i < NCETA; ++i ) fprintf(f, " %.9g", flat(-3, 3));
+    fprintf(f, "\n");
+  }
+  fclose(f);
+}
+
+// Writes the set into a new temporary directory and returns its name
+inline std::string writeCorrectionSet()
+{
+  char dirname[] = "/tmp/RoccoRTestXXXXXX";
+  if ( !mkdtemp(dirname) ) return "";
+  const std::string dir = dirname;
+
+  FILE* f = fopen((dir+"/config.txt").c_str(), "w");
+  fprintf(f, "RC 0 1\nRC 1 2\n");
+  fclose(f);
+  writeCorrectionFile(dir+"/0.0.txt", 0, 0, 1);
+  writeCorrectionFile(dir+"/1.0.txt", 1, 0, 2);
+  return dir;
+}
+
+inline void removeCorrectionSet(const std::string& dir)
+{
+  for ( auto name : {"config.txt", "0.0.txt", "1.0.txt", "rcdata.bin"} ) std::remove((dir+"/"+name).c_str());
+  std::remove(dir.c_str());
+}
+
+}
+
+#endif
@@ -0,0 +1,76 @@
+// Time per random number of the kinematic reconstruction smearing with gRandom (TRandom3, reseeded per
+// combination) and with the counter based generator (kinRecoCounterBasedRandom), drawn from a histogram
+// like the resolution inputs. A smearing trial draws 9 numbers from histograms and 4 flat ones.
+// usage: benchKinRecoRandom [ncombinations]
+
+#include "CATTools/CatAnalyzer/interface/CounterBasedRandom.h"
+
+#include <TH1F.h>
+#include <TMath.h>
+#include <TRandom3.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+  // Same as KinematicReconstruction::getRandom with a counter based generator
+  double getRandom(TH1* h, cat::CounterBasedRandom& rng)
+  {
+    const int n = h->GetNbinsX();
+    const double* integral = h->GetIntegral();
+    if ( integral[n] == 0 ) return 0;
+
+    const double r1 = rng.flat();
+    const int ibin = TMath::BinarySearch(n, integral, r1);
+    double x = h->GetBinLowEdge(ibin+1);
+    if ( r1 > integral[ibin] ) x += h->GetBinWidth(ibin+1)*(r1-integral[ibin])/(integral[ibin+1]-integral[ibin]);
+
+    return x;
+  }
+
+  template<typename F>
+  double nsPerNumber(const int nCombinations, F trial)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    for ( int i = 0; i < nCombinations; ++i ) trial(i);
+    const auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop-start).count()/nCombinations/100/13;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  const int nCombinations = argc > 1 ? std::atoi(argv[1]) : 20000;
+
+  TH1F h("h", "resolution", 200, 0, 2);
+  TRandom3 fill(1);
+  for ( int i = 0; i < 100000; ++i ) h.Fill(fill.Gaus(1, 0.15));
+  h.ComputeIntegral();
+
+  gRandom = new TRandom3();
+  TRandom3 r3;
+  double sum = 0;
+  const double tROOT = nsPerNumber(nCombinations, [&](const int i) {
+    gRandom->SetSeed(1000+i);
+    r3.SetSeed(1000+i);
+    for ( int sm = 0; sm < 100; ++sm ) {
+      for ( int j = 0; j < 9; ++j ) sum += h.GetRandom();
+      for ( int j = 0; j < 4; ++j ) sum += r3.Rndm();
+    }
+  });
+  const double tCounter = nsPerNumber(nCombinations, [&](const int i) {
+    cat::CounterBasedRandom rng(12345, 1000+i);
+    for ( int sm = 0; sm < 100; ++sm ) {
+      rng.setTrial(sm);
+      for ( int j = 0; j < 9; ++j ) sum += getRandom(&h, rng);
+      for ( int j = 0; j < 4; ++j ) sum += rng.flat();
+    }
+  });
+
+  std::cout << nCombinations << " combinations of 100 trials" << std::endl;
+  std::cout << "gRandom/TRandom3: " << tROOT << " ns per number" << std::endl;
+  std::cout << "counter based:    " << tCounter << " ns per number" << std::endl;
+  std::cout << "(checksum " << sum << ")" << std::endl;
+  return 0;
+}
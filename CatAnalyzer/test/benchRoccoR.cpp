@@ -0,0 +1,87 @@
+// Per-muon time of the RoccoR MC corrections with the analytic and the tabulated (rocCorTabulate)
+// CrystalBall inverse CDF, and the largest difference of the corrections between the two.
+// usage: benchRoccoR [ngrid] [nmuons]
+
+#include "CATTools/CatAnalyzer/src/RoccoR.cc"
+#include "RoccoRTestInputs.h"
+
+#include <chrono>
+#include <random>
+
+namespace {
+  struct Muons {
+    std::vector<int> Q, n;
+    std::vector<double> pt, eta, phi, gt, u, w;
+  };
+
+  Muons generate(int nmuons)
+  {
+    std::mt19937 rnd(4357);
+    std::uniform_real_distribution<double> flat(0, 1);
+    Muons mu;
+    for ( int i = 0; i < nmuons; ++i ) {
+      mu.Q.push_back(flat(rnd) < 0.5 ? -1 : 1);
+      mu.pt.push_back(20/(1-0.9*flat(rnd)));
+      mu.eta.push_back(4.8*flat(rnd)-2.4);
+      mu.phi.push_back(6.28*flat(rnd)-3.14);
+      mu.n.push_back(6 + int(5*flat(rnd))); // RMIN and RTRK of the inputs
+      mu.gt.push_back(mu.pt.back()*(1+0.02*(flat(rnd)-0.5)));
+      mu.u.push_back(flat(rnd));
+      mu.w.push_back(flat(rnd));
+    }
+    return mu;
+  }
+
+  // ns per muon of one correction applied to all muons, the corrections are returned in k
+  template<typename F>
+  double timePerMuon(int nmuons, std::vector<double>& k, F f)
+  {
+    k.assign(nmuons, 0);
+    const auto start = std::chrono::steady_clock::now();
+    for ( int i = 0; i < nmuons; ++i ) k[i] = f(i);
+    const auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop-start).count()/nmuons;
+  }
+
+  // Compared in 1/k, which is linear in the inverse CDF, k itself has a pole where the smearing reaches -pt
+  double maxDiff(const std::vector<double>& a, const std::vector<double>& b)
+  {
+    double d = 0;
+    for ( size_t i = 0; i < a.size(); ++i ) d = std::max(d, std::abs(1/a[i]-1/b[i]));
+    return d;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  const int ngrid = argc > 1 ? std::atoi(argv[1]) : 4096;
+  const int nmuons = argc > 2 ? std::atoi(argv[2]) : 1000000;
+
+  const std::string dir = RoccoRTest::writeCorrectionSet();
+  if ( dir.empty() ) { std::cout << "cannot create the input directory" << std::endl; return 1; }
+  RoccoR analytic(dir), tabulated(dir);
+  tabulated.tabulate(ngrid);
+  RoccoRTest::removeCorrectionSet(dir);
+
+  const Muons mu = generate(nmuons);
+  auto smear = [&](const RoccoR& rc) {
+    return [&](int i) { return rc.kScaleAndSmearMC(mu.Q[i], mu.pt[i], mu.eta[i], mu.phi[i], mu.n[i], mu.u[i], mu.w[i]); };
+  };
+  auto fromGen = [&](const RoccoR& rc) {
+    return [&](int i) { return rc.kScaleFromGenMC(mu.Q[i], mu.pt[i], mu.eta[i], mu.phi[i], mu.n[i], mu.gt[i], mu.w[i]); };
+  };
+
+  std::vector<double> ka, kt;
+  std::cout << nmuons << " muons, ngrid " << ngrid << std::endl;
+  const double ta = timePerMuon(nmuons, ka, smear(analytic)), tt = timePerMuon(nmuons, kt, smear(tabulated));
+  const double dSmear = maxDiff(ka, kt);
+  std::cout << "kScaleAndSmearMC: analytic " << ta << " ns, tabulated " << tt << " ns per muon, max |d(1/k)| " << dSmear << std::endl;
+  const double ga = timePerMuon(nmuons, ka, fromGen(analytic)), gtab = timePerMuon(nmuons, kt, fromGen(tabulated));
+  const double dFromGen = maxDiff(ka, kt);
+  std::cout << "kScaleFromGenMC:  analytic " << ga << " ns, tabulated " << gtab << " ns per muon, max |d(1/k)| " << dFromGen << std::endl;
+
+  // The corrections are a few % wide, the interpolation error is 2e-4 of that at most
+  const bool ok = dSmear < 1e-5 and dFromGen < 1e-5;
+  std::cout << (ok ? "OK" : "FAILED") << std::endl;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+#!/usr/bin/env python
+## Compare the full copy and the friendSystematicTrees layouts of TtbarDiLeptonAnalyzer
+##   - runs run_TtbarDiLeptonAnalyzer_cfg.py with both layouts on the same MC events and times the jobs
+##   - prints the file sizes and the bytes per tree
+##   - reads every variation through the nominal friend and compares it with the full copy trees
+## usage: compareSystematicTreeLayouts.py [maxEvents] [inputFile ...]
+##        compareSystematicTreeLayouts.py -r full.root friend.root  (compare existing outputs only)
+
+import sys, os, time, subprocess
+
+sys.path.append("%s/src/CATTools/CatAnalyzer/python" % os.environ['CMSSW_BASE'])
+
+## Unchanged branches which are read from the nominal tree in the friend layout.
+## They are not filled for the variations in the full copy layout, and stay at their reset value there.
+nominalValueBranches = ['weight', 'puweight', 'genweight', 'topPtWeight',
+                        'partonChannel', 'partonMode1', 'partonMode2',
+                        'partonInPhase', 'partonInPhaseLep', 'partonInPhaseJet', 'partonlep1_pid', 'partonlep2_pid',
+                        'pseudoChannel', 'pseudoInPhase', 'pseudolep1_pid', 'pseudolep2_pid']
+
+def runJob(friend, maxEvents, inputFiles):
+    cfgName = "run_TtbarDiLeptonAnalyzer_%s_cfg.py" % ("friend" if friend else "full")
+    outName = "cattree_%s.root" % ("friend" if friend else "full")
+    cfg = open(cfgName, "w")
+    print>>cfg, "execfile('%s/run_TtbarDiLeptonAnalyzer_cfg.py')" % os.path.dirname(os.path.abspath(__file__))
+    print>>cfg, "process.maxEvents.input = %d" % maxEvents
+    if inputFiles: print>>cfg, "process.source.fileNames = %s" % repr(inputFiles)
+    else: print>>cfg, "process.source.fileNames = commonTestCATTuples['sig']"
+    print>>cfg, "process.cattree.friendSystematicTrees = cms.bool(%s)" % friend
+    ## Same smearing in both jobs whatever the order the systematics are evaluated
+    print>>cfg, "process.cattree.solver.counterBasedRandom = cms.bool(True)"
+    print>>cfg, "process.cattree.kinRecoCounterBasedRandom = cms.bool(True)"
+    print>>cfg, "process.TFileService.fileName = '%s'" % outName
+    cfg.close()
+
+    start = time.time()
+    if subprocess.call(["cmsRun", cfgName]) != 0:
+        print "!!! cmsRun failed for", cfgName
+        sys.exit(1)
+    return outName, time.time()-start
+
+def printSizes(fileName):
+    f = ROOT.TFile(fileName)
+    print "%s: %.1f kB" % (fileName, os.path.getsize(fileName)/1024.)
+    d = f.Get("cattree")
+    for key in d.GetListOfKeys():
+        t = key.ReadObj()
+        if not t.InheritsFrom("TTree"): continue
+        print "  %-6s %8d entries %4d branches %10.1f kB zipped %10.1f kB" % (
+            t.GetName(), t.GetEntries(), t.GetListOfBranches().GetEntries(), t.GetZipBytes()/1024., t.GetTotBytes()/1024.)
+
+def value(tree, name):
+    x = getattr(tree, name)
+    if hasattr(x, 'Px'): return (x.Px(), x.Py(), x.Pz(), x.E())
+    if hasattr(x, 'size'): return tuple(x)
+    return x
+
+def compare(fullName, friendName):
+    from histoHelper import getTree
+    fFull, fFriend = ROOT.TFile(fullName), ROOT.TFile(friendName)
+    nomFull, nomFriend = fFull.Get("cattree/nom"), fFriend.Get("cattree/nom")
+    nomBranches = [b.GetName() for b in nomFull.GetListOfBranches()]
+    ## Separate copy of the friend nominal tree, not the one attached to the variation trees
+    fRef = ROOT.TFile(friendName)
+    nomRef = fRef.Get("cattree/nom")
+
+    nBad = 0
+    ## Nominal: the same events plus the ones selected only by a variation, which are not selected (step -1)
+    fullEntries = {}
+    for i in xrange(nomFull.GetEntries()):
+        nomFull.GetEntry(i)
+        fullEntries[(nomFull.run, nomFull.event)] = i
+    for i in xrange(nomFriend.GetEntries()):
+        nomFriend.GetEntry(i)
+        key = (nomFriend.run, nomFriend.event)
+        if key not in fullEntries:
+            if nomFriend.step != -1:
+                print "!!! nom: event", key, "selected only in the friend layout"
+                nBad += 1
+            continue
+        nomFull.GetEntry(fullEntries.pop(key))
+        for b in nomBranches:
+            if value(nomFull, b) != value(nomFriend, b):
+                print "!!! nom:", b, "differs for event", key
+                nBad += 1
+    if fullEntries:
+        print "!!! nom:", len(fullEntries), "events missing in the friend layout"
+        nBad += len(fullEntries)
+
+    ## Variations: same entries as the full copy, the unchanged branches through the friend
+    for key in fFull.Get("cattree").GetListOfKeys():
+        name = key.GetName()
+        if name == "nom" or not key.ReadObj().InheritsFrom("TTree"): continue
+        sysFull, sysFriend = fFull.Get("cattree/"+name), getTree(fFriend, "cattree/"+name)
+        if sysFull.GetEntries() != sysFriend.GetEntries():
+            print "!!! %s: %d entries in the full copy, %d in the friend layout" % (name, sysFull.GetEntries(), sysFriend.GetEntries())
+            nBad += 1
+            continue
+        branches = [b.GetName() for b in sysFull.GetListOfBranches()]
+        nFromNominal = 0
+        for i in xrange(sysFull.GetEntries()):
+            sysFull.GetEntry(i)
+            sysFriend.GetEntry(i)
+            key = (sysFriend.run, sysFriend.event)
+            for b in branches:
+                expected = value(sysFull, b)
+                if b in nominalValueBranches:
+                    ## Documented change: the nominal value instead of the reset value
+                    expected = value(nomRef, b) if nomRef.GetEntryWithIndex(*key) > 0 else None
+                    nFromNominal += 1
+                if value(sysFriend, b) != expected:
+                    print "!!! %s: %s differs for entry %d" % (name, b, i)
+                    nBad += 1
+        print "%-6s %8d entries, %d branches compared, %d values read from the nominal tree" % (name, sysFull.GetEntries(), len(branches), nFromNominal)
+
+    print "friend read-back:", "OK" if nBad == 0 else "%d differences" % nBad
+    return nBad
+
+if __name__ == '__main__':
+    import ROOT
+    ROOT.gROOT.SetBatch(True)
+    if len(sys.argv) > 3 and sys.argv[1] == '-r':
+        fullName, friendName = sys.argv[2], sys.argv[3]
+    else:
+        maxEvents = int(sys.argv[1]) if len(sys.argv) > 1 else 2000
+        fullName, fullTime = runJob(False, maxEvents, sys.argv[2:])
+        friendName, friendTime = runJob(True, maxEvents, sys.argv[2:])
+        print "job time: full copy %.1f s, friend %.1f s" % (fullTime, friendTime)
+    printSizes(fullName)
+    printSizes(friendName)
+    sys.exit(compare(fullName, friendName) != 0)
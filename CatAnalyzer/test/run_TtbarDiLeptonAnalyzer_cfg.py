@@ -64,12 +64,34 @@ process.cattree = cms.EDAnalyzer("TtbarDiLeptonAnalyzer",
     dstars = cms.InputTag("catDstars","DstarCand"),
     Jpsis  = cms.InputTag("catDstars","JpsiCand"),
     matchingDeltaR = cms.double(0.15),
+    ## D0, D* and J/psi as float arrays with indices to a shared daughter table, instead of TClonesArray
+    #flatCharmCandidates = cms.bool(True),
 ## Dstar end
 
     #solver = process.ttbarDileptonKinAlgoPSetCMSKin,
     solver = process.ttbarDileptonKinAlgoPSetDESYSmeared,
     solverPseudoTop = process.ttbarDileptonKinAlgoPSetDESYSmearedPseudoTop,
     #solver = process.ttbarDileptonKinAlgoPSetDESYMassLoop,
+
+    ## Keep only the branches changed by the variation in the systematic trees, with run, event to be attached
+    ## to the nominal tree as a friend through its index. Compare the layouts with test/compareSystematicTreeLayouts.py
+    #friendSystematicTrees = cms.bool(True),
+
+    ## Draw the kinematic reconstruction smearing from a counter based generator keyed by run, event,
+    ## the combination and the trial instead of reseeding gRandom. The desy* solutions change but stay
+    ## statistically equivalent, and no longer depend on the evaluation order
+    #kinRecoCounterBasedRandom = cms.bool(True),
+
+    ## Evaluate the lepton-jet combinations of the kinematic reconstruction on the TBB worker threads,
+    ## the solutions are the same as in the serial evaluation. Needs kinRecoCounterBasedRandom
+    #kinRecoParallel = cms.bool(True),
+
+    ## Write the four-vectors as float <name>_pt, _eta, _phi, _m branches instead of TLorentzVector,
+    ## keeping mantissaBits (0-23) of the float mantissa, by default or for the given branch
+    #flatP4 = cms.PSet(
+    #    mantissaBits = cms.int32(23),
+    #    partonttbar = cms.int32(10),
+    #),
 )
 #process.cattree.solver.tMassStep = 1
 if cms.string('DESYSmeared') == process.cattree.solver.algo:
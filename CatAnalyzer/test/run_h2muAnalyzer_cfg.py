@@ -61,6 +61,7 @@ process.cattree = cms.EDAnalyzer("h2muAnalyzer",
         src = cms.InputTag("catElectrons"),
         effSF = electronSFCutBasedIDMediumWP,#electronSFWP90,
     ),
+    #rocCorTabulate = cms.int32(4096), # tabulated RoccoR smearing, within 2e-4 of the resolution, see test/benchRoccoR.cpp
 )
 
 process.TFileService = cms.Service("TFileService",
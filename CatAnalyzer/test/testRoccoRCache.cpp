@@ -0,0 +1,93 @@
+// Corrections from the RoccoR binary cache must be bit-identical to the ones parsed from the text files,
+// and a changed text input must make the cache stale.
+
+#include "CATTools/CatAnalyzer/src/RoccoR.cc"
+#include "RoccoRTestInputs.h"
+
+#include <cstring>
+#include <unistd.h>
+
+namespace {
+  bool sameBits(double a, double b) { return std::memcmp(&a, &b, sizeof(double)) == 0; }
+
+  // Number of corrections differing between the two sets over a (charge, pt, eta, phi) grid
+  int compare(const RoccoR& a, const RoccoR& b, int& ncompared)
+  {
+    int nbad = 0;
+    for ( int s = 0; s < a.Nset(); ++s ) {
+      for ( int m = 0; m < a.Nmem(s); ++m ) {
+        for ( int Q = -1; Q <= 1; Q += 2 ) {
+          for ( double pt = 5; pt < 500; pt *= 1.37 ) {
+            for ( double eta = -2.5; eta <= 2.5; eta += 0.13 ) {
+              for ( double phi = -3.2; phi <= 3.2; phi += 0.21 ) {
+                const int n = 6 + int(pt)%5; // RMIN and RTRK of the inputs, the parameters are not set beyond
+                const double u = std::fmod(pt*7.1+eta, 1.0), w = std::fmod(phi*3.3+10, 1.0);
+                double x[5] = {a.kScaleDT(Q, pt, eta, phi, s, m),
+                               a.kScaleAndSmearMC(Q, pt, eta, phi, n, u, w, s, m),
+                               a.kScaleFromGenMC(Q, pt, eta, phi, n, pt*(1+0.02*(u-0.5)), w, s, m),
+                               a.kGenSmear(pt, eta, w, u, RocRes::Data, s, m),
+                               a.kGenSmear(pt, eta, w, u, RocRes::MC, s, m)};
+                double y[5] = {b.kScaleDT(Q, pt, eta, phi, s, m),
+                               b.kScaleAndSmearMC(Q, pt, eta, phi, n, u, w, s, m),
+                               b.kScaleFromGenMC(Q, pt, eta, phi, n, pt*(1+0.02*(u-0.5)), w, s, m),
+                               b.kGenSmear(pt, eta, w, u, RocRes::Data, s, m),
+                               b.kGenSmear(pt, eta, w, u, RocRes::MC, s, m)};
+                for ( int i = 0; i < 5; ++i ) {
+                  ++ncompared;
+                  if ( !sameBits(x[i], y[i]) ) ++nbad;
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+    return nbad;
+  }
+}
+
+int main()
+{
+  const std::string dir = RoccoRTest::writeCorrectionSet();
+  if ( dir.empty() ) { std::cout << "cannot create the input directory" << std::endl; return 1; }
+  const std::string cachename = dir+"/rcdata.bin";
+  int nfail = 0;
+
+  RoccoR text(dir);
+  RoccoR first(dir, cachename); // writes the cache
+  RoccoR cached;
+  if ( !cached.readCache(cachename, RoccoR::inputKey(dir)) ) {
+    std::cout << "FAIL: the cache written from the text files cannot be read back" << std::endl;
+    ++nfail;
+  }
+  else {
+    int ncompared = 0;
+    const int nbad = compare(text, cached, ncompared);
+    std::cout << "text vs cache: " << nbad << " of " << ncompared << " corrections differ" << std::endl;
+    if ( nbad != 0 or ncompared == 0 or cached.Nset() != 2 or cached.Nmem(1) != 2 ) ++nfail;
+  }
+
+  // Append to a correction file, the cache must be ignored and rewritten
+  const unsigned long long key = RoccoR::inputKey(dir);
+  FILE* f = fopen((dir+"/1.0.txt").c_str(), "a");
+  fprintf(f, "# modified\n");
+  fclose(f);
+  RoccoR stale;
+  if ( RoccoR::inputKey(dir) == key or stale.readCache(cachename, RoccoR::inputKey(dir)) ) {
+    std::cout << "FAIL: the cache is not stale after a change of the inputs" << std::endl;
+    ++nfail;
+  }
+  RoccoR rewritten(dir, cachename);
+  if ( !stale.readCache(cachename, RoccoR::inputKey(dir)) ) {
+    std::cout << "FAIL: the stale cache is not rewritten" << std::endl;
+    ++nfail;
+  }
+  if ( access((cachename+"."+gSystem->HostName()+"."+std::to_string(gSystem->GetPid())+".tmp").c_str(), F_OK) == 0 ) {
+    std::cout << "FAIL: the temporary cache file is left behind" << std::endl;
+    ++nfail;
+  }
+
+  RoccoRTest::removeCorrectionSet(dir);
+  std::cout << (nfail == 0 ? "OK" : "FAILED") << std::endl;
+  return nfail;
+}
@@ -11,6 +11,7 @@
 #include "SimDataFormats/PileupSummaryInfo/interface/PileupSummaryInfo.h"
 #include "DataFormats/VertexReco/interface/Vertex.h"
 #include "DataFormats/VertexReco/interface/VertexFwd.h"
+#include "CATTools/CatProducer/plugins/PileupWeightTable.h"
 
 #include "DataFormats/Common/interface/View.h"
 
@@ -30,6 +31,7 @@ public:
 
 private:
   edm::LumiReWeighting lumiWeights_, lumiWeightsUp_, lumiWeightsDn_;
+  PileupWeightTable weightTable_;
 
   enum class WeightingMethod { Standard, RedoWeight, NVertex };
   WeightingMethod weightingMethod_;
@@ -94,6 +96,8 @@ CATPileupWeightProducer::CATPileupWeightProducer(const edm::ParameterSet& pset)
     lumiWeights_ = edm::LumiReWeighting(pileupMCTmp, pileupRDTmp);
     lumiWeightsUp_ = edm::LumiReWeighting(pileupMCTmp, pileupUpTmp);
     lumiWeightsDn_ = edm::LumiReWeighting(pileupMCTmp, pileupDnTmp);
+
+    weightTable_ = PileupWeightTable(pileupMCTmp.size(), lumiWeights_, lumiWeightsUp_, lumiWeightsDn_);
   }
 
   produces<int>("nTrueInteraction");
@@ -144,9 +148,10 @@ void CATPileupWeightProducer::produce(edm::Event& event, const edm::EventSetup&
       }
 
       if ( *nTrueIntr > 0 ) {
-        *weight   = lumiWeights_.weight(*nTrueIntr);
-        *weightUp = lumiWeightsUp_.weight(*nTrueIntr);
-        *weightDn = lumiWeightsDn_.weight(*nTrueIntr);
+        const float* w = weightTable_.row(*nTrueIntr);
+        *weight   = w[PileupWeightTable::W_NOM];
+        *weightUp = w[PileupWeightTable::W_UP];
+        *weightDn = w[PileupWeightTable::W_DN];
       }
     }
   }
@@ -0,0 +1,39 @@
+#ifndef CATTools_CatProducer_PileupWeightTable_H
+#define CATTools_CatProducer_PileupWeightTable_H
+
+#include "PhysicsTools/Utilities/interface/LumiReWeighting.h"
+
+#include <algorithm>
+#include <vector>
+
+// Pileup weights tabulated per nTrueInteraction bin, nominal/up/down side by side.
+// The last row holds the value for nTrueInteraction beyond the histogram range,
+// so every integer nTrueInteraction gives the same weights as LumiReWeighting::weight().
+class PileupWeightTable
+{
+public:
+  enum { W_NOM=0, W_UP, W_DN, W_NVAR };
+
+  PileupWeightTable() {};
+  PileupWeightTable(const int nBins, edm::LumiReWeighting& nom, edm::LumiReWeighting& up, edm::LumiReWeighting& dn):
+    table_((nBins+1)*W_NVAR)
+  {
+    for ( int i=0; i<=nBins; ++i ) {
+      table_[i*W_NVAR+W_NOM] = nom.weight(i);
+      table_[i*W_NVAR+W_UP ] = up.weight(i);
+      table_[i*W_NVAR+W_DN ] = dn.weight(i);
+    }
+  }
+
+  // Nominal, up and down weights for nTrueIntr >= 0
+  const float* row(const int nTrueIntr) const
+  {
+    const int nRows = table_.size()/W_NVAR;
+    return &table_[std::min(nTrueIntr, nRows-1)*W_NVAR];
+  }
+
+private:
+  std::vector<float> table_;
+};
+
+#endif
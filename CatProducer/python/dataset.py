@@ -5,6 +5,8 @@ import pprint
 import re
 import pickle
 import sys
+import json
+import sqlite3
 
 from CATTools.CatProducer.castorBaseDir import castorBaseDir
 import CATTools.CatProducer.eostools as castortools
@@ -110,6 +112,12 @@ class BaseDataset( object ):
 
         return [f for f in subset]
 
+    def splitByEvents(self, nJobs=None, eventsPerJob=None, index=None, treeName='Events'):
+        """Split the good files into jobs with balanced number of events, using the per-file
+        entries from the FileMetadataIndex. Only for files accessible from the local file system."""
+        if index is None: index = FileMetadataIndex()
+        return index.split(self.listOfGoodFiles(), nJobs, eventsPerJob, treeName)
+
 class CMSDataset( BaseDataset ):
 
     def __init__(self, name, run_range = None):
@@ -221,9 +229,13 @@ class LocalDataset( BaseDataset ):
         sampleName = self.name.rstrip('/')
         sampleDir = ''.join( [os.path.abspath(self.basedir), sampleName ] )
         self.files = []
+        self.filesAndSizes = {}
         for file in sorted(os.listdir( sampleDir )):
             if pat.match( file ) is not None:
-                self.files.append( '/'.join([sampleDir, file]) )
+                path = '/'.join([sampleDir, file])
+                self.files.append( path )
+                ## keep the size from the same directory listing, no need to walk again
+                self.filesAndSizes[path] = str(os.stat(path).st_size)
                 # print file
 ##         dbs = 'dbs search --query="find file where dataset like %s"' % sampleName
 ##         dbsOut = os.popen(dbs)
@@ -236,6 +248,10 @@ class LocalDataset( BaseDataset ):
 ##             self.files.append(line)
 
         
+    def extractFileSizes(self):
+        '''File sizes are already collected in buildListOfFiles.'''
+        pass
+
 
 class Dataset( BaseDataset ):
     
@@ -319,6 +335,106 @@ class Dataset( BaseDataset ):
         return -1
 
 
+class FileMetadataIndex( object ):
+    """Per-file metadata cached in a small sqlite database.
+
+    Each file is keyed by its path and modification time, and holds the file size,
+    the number of entries of every TTree and the sum of weights of weightExpr evaluated
+    on weightTree. Files are read with ROOT only when they are new or modified since
+    the last update, so the index can be refreshed cheaply after adding files."""
+
+    def __init__(self, dbFile=None, weightTree='Events', weightExpr=None):
+        if dbFile is None:
+            cachedir = '/'.join( [os.environ['HOME'],'.cmgdataset'])
+            if not os.path.exists(cachedir): os.mkdir(cachedir)
+            dbFile = '/'.join([cachedir, 'fileMetadata.db'])
+        self.weightTree = weightTree
+        self.weightExpr = weightExpr if weightExpr else ''
+        self.db = sqlite3.connect(dbFile)
+        self.db.execute("""CREATE TABLE IF NOT EXISTS files (
+            path TEXT PRIMARY KEY, mtime REAL, size INTEGER,
+            entries TEXT, weightExpr TEXT, sumWeights REAL)""")
+
+    def lookup(self, path):
+        '''Returns the metadata of a file, or None if not indexed or outdated.'''
+        path = os.path.abspath(path)
+        row = self.db.execute("SELECT mtime, size, entries, weightExpr, sumWeights FROM files WHERE path=?",
+                              (path,)).fetchone()
+        if row is None: return None
+        mtime, size, entries, weightExpr, sumWeights = row
+        if mtime != os.stat(path).st_mtime or weightExpr != self.weightExpr: return None
+        return {'size':size, 'entries':json.loads(entries), 'sumWeights':sumWeights}
+
+    def update(self, paths):
+        '''Read new or modified files and store them. Returns the number of files read.'''
+        nRead = 0
+        for path in paths:
+            if self.lookup(path) is not None: continue
+            path = os.path.abspath(path)
+            st = os.stat(path)
+            entries, sumWeights = self.readFile(path)
+            self.db.execute("INSERT OR REPLACE INTO files VALUES (?,?,?,?,?,?)",
+                            (path, st.st_mtime, st.st_size, json.dumps(entries), self.weightExpr, sumWeights))
+            nRead += 1
+        self.db.commit()
+        return nRead
+
+    def readFile(self, path):
+        import ROOT
+        f = ROOT.TFile.Open(path)
+        if not f or f.IsZombie(): raise IOError("Cannot open %s" % path)
+
+        entries = {}
+        def walk(d, prefix):
+            for name in set(key.GetName() for key in d.GetListOfKeys()):
+                obj = d.Get(name)
+                if obj.InheritsFrom("TTree"): entries[prefix+name] = obj.GetEntries()
+                elif obj.InheritsFrom("TDirectory"): walk(obj, prefix+name+'/')
+        walk(f, '')
+
+        sumWeights = entries.get(self.weightTree, 0)
+        if self.weightExpr and self.weightTree in entries:
+            ROOT.gROOT.cd()
+            h = ROOT.TH1D("hSumWeights", "", 1, 0, 1)
+            f.Get(self.weightTree).Project("hSumWeights", "0.5", self.weightExpr)
+            sumWeights = h.GetBinContent(1)
+            h.Delete()
+        f.Close()
+
+        return entries, sumWeights
+
+    def split(self, paths, nJobs=None, eventsPerJob=None, treeName='Events'):
+        """Split files into jobs with the same number of events.
+        Each job is a dict of fileNames, skipEvents and maxEvents for the PoolSource."""
+        self.update(paths)
+        files = []
+        for path in paths:
+            n = self.lookup(path)['entries'].get(treeName, 0)
+            if n > 0: files.append((path, n))
+        nTotal = sum(n for path, n in files)
+        if nTotal == 0: return []
+        if eventsPerJob is None:
+            if nJobs is None: nJobs = len(files)
+            eventsPerJob = (nTotal+nJobs-1)/nJobs
+
+        jobs = []
+        ifile, fileBegin = 0, 0
+        for begin in range(0, nTotal, eventsPerJob):
+            end = min(begin+eventsPerJob, nTotal)
+            while fileBegin+files[ifile][1] <= begin:
+                fileBegin += files[ifile][1]
+                ifile += 1
+            fileNames = []
+            i, iBegin = ifile, fileBegin
+            while iBegin < end:
+                fileNames.append(files[i][0])
+                iBegin += files[i][1]
+                i += 1
+            jobs.append({'fileNames':fileNames, 'skipEvents':begin-fileBegin, 'maxEvents':end-begin})
+
+        return jobs
+
+
 def createDataset( user, dataset, pattern,  readcache=False, basedir=None, run_range = None):
     
     cachedir =  '/'.join( [os.environ['HOME'],'.cmgdataset'])
@@ -0,0 +1,46 @@
+// The pileup weights tabulated in CATPileupWeightProducer must be the ones of LumiReWeighting::weight()
+// for every nTrueInteraction the producer looks up, including the empty MC bins and beyond the histogram range.
+
+#include "CATTools/CatProducer/plugins/PileupWeightTable.h"
+
+#include <cmath>
+#include <iostream>
+#include <numeric>
+
+namespace {
+  // Normalised like in CATPileupWeightProducer
+  std::vector<float> distribution(const int nBins, const double mean, const double width)
+  {
+    std::vector<double> h(nBins);
+    for ( int i=0; i<nBins; ++i ) h[i] = std::exp(-0.5*std::pow((i+0.5-mean)/width, 2));
+    h[nBins-1] = 0; // an empty bin at the end of the range
+    const double sumW = std::accumulate(h.begin(), h.end(), 0.);
+    std::vector<float> out;
+    for ( auto x : h ) out.push_back(x/sumW);
+    return out;
+  }
+}
+
+int main()
+{
+  const int nBins = 75;
+  const std::vector<float> pileupMC = distribution(nBins, 20, 9);
+  edm::LumiReWeighting lumiWeights(pileupMC, distribution(nBins, 23, 10));
+  edm::LumiReWeighting lumiWeightsUp(pileupMC, distribution(nBins, 25, 11));
+  edm::LumiReWeighting lumiWeightsDn(pileupMC, distribution(nBins, 21, 9));
+  const PileupWeightTable table(nBins, lumiWeights, lumiWeightsUp, lumiWeightsDn);
+
+  int nBad = 0, nCompared = 0;
+  for ( int nTrueIntr=1; nTrueIntr<nBins+50; ++nTrueIntr ) {
+    const float* w = table.row(nTrueIntr);
+    const float expected[] = {float(lumiWeights.weight(nTrueIntr)), float(lumiWeightsUp.weight(nTrueIntr)), float(lumiWeightsDn.weight(nTrueIntr))};
+    for ( int i=0; i<PileupWeightTable::W_NVAR; ++i ) {
+      ++nCompared;
+      if ( w[i] == expected[i] ) continue;
+      std::cout << "nTrueInteraction " << nTrueIntr << " variation " << i << ": table " << w[i] << ", LumiReWeighting " << expected[i] << std::endl;
+      ++nBad;
+    }
+  }
+  std::cout << nBad << " of " << nCompared << " pileup weights differ" << std::endl;
+  return nBad == 0 ? 0 : 1;
+}
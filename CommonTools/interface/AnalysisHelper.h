@@ -11,6 +11,9 @@
 
 #include "TLorentzVector.h"
 
+#include <map>
+#include <cstdint>
+
 namespace cat {
 
   TLorentzVector ToTLorentzVector(const math::XYZTLorentzVector& t);
@@ -31,10 +34,37 @@ namespace cat {
   typedef GreaterByPt<reco::Candidate> GtByCandPt;
   bool GtByTLVPt( TLorentzVector & t1, TLorentzVector & t2 );
 
+  // Trigger path patterns resolved to the list of matching path indices.
+  // The lists are rebuilt only when the trigger menu changes, so an event query
+  // reads the accept bits of the matching paths without any string comparison.
+  // Keep one instance per module and pass it to the AnalysisHelper every event.
+  class TriggerPathIndex {
+  public:
+    void update(const edm::TriggerNames& triggerNames);
+    // Registers the pattern if not known yet. Paths containing the pattern match,
+    // or only the ones starting with it if prefixOnly is set (trigger object matching)
+    int handle(const std::string& pattern, const bool prefixOnly = false);
+    bool fired(const int handle, const edm::TriggerResults& triggerResults) const;
+    const std::vector<unsigned int>& paths(const int handle) const { return paths_[handle]; }
+
+  private:
+    void resolve(const int handle);
+
+    const edm::TriggerNames* triggerNames_ = 0;
+    edm::ParameterSetID psetID_;
+    std::map<std::pair<std::string, bool>, int> handles_;
+    std::vector<std::string> patterns_;
+    std::vector<bool> prefixOnly_;
+    std::vector<std::vector<unsigned int> > paths_;
+  };
+
   class AnalysisHelper {
   public:
-    AnalysisHelper(){triggerInfoSet_ = false;}
-    AnalysisHelper(const edm::TriggerNames& triggerNames, edm::Handle<edm::TriggerResults> triggerResults, edm::Handle<pat::TriggerObjectStandAloneCollection> triggerObjects){triggerNames_ = triggerNames; triggerResults_ = triggerResults; triggerObjects_ = triggerObjects; triggerInfoSet_ = true;}
+    AnalysisHelper(){triggerInfoSet_ = false; pathIndex_ = 0;}
+    AnalysisHelper(const edm::TriggerNames& triggerNames, edm::Handle<edm::TriggerResults> triggerResults, edm::Handle<pat::TriggerObjectStandAloneCollection> triggerObjects){triggerNames_ = triggerNames; triggerResults_ = triggerResults; triggerObjects_ = triggerObjects; triggerInfoSet_ = true; pathIndex_ = 0;}
+    // triggerFired() goes through the compiled path index
+    AnalysisHelper(const edm::TriggerNames& triggerNames, edm::Handle<edm::TriggerResults> triggerResults, edm::Handle<pat::TriggerObjectStandAloneCollection> triggerObjects, TriggerPathIndex& pathIndex):
+      AnalysisHelper(triggerNames, triggerResults, triggerObjects) { pathIndex_ = &pathIndex; pathIndex_->update(triggerNames); }
     ~AnalysisHelper(){}
 
     bool triggerNotSet();
@@ -43,11 +73,25 @@ namespace cat {
     void listFiredTriggers();
   
   private:
+    // Trigger objects are unpacked once per event (i.e. per helper) on the first
+    // triggerMatched() call, keeping only what the matching needs
+    void unpackTriggerObjects();
+    std::vector<unsigned int> pathsWithPrefix(const std::string& trigname);
+    const std::vector<unsigned int>& triggerObjectsForPath(const std::string& trigname);
 
     edm::TriggerNames triggerNames_;
     edm::Handle<edm::TriggerResults> triggerResults_;
     edm::Handle<pat::TriggerObjectStandAloneCollection> triggerObjects_;
     bool triggerInfoSet_;
+    TriggerPathIndex* pathIndex_;
+
+    bool triggerObjectsUnpacked_ = false;
+    std::vector<double> trigObjEtas_, trigObjPhis_;
+    // Bits over the path index of the paths with the last filter and L3 filter accepted,
+    // trigObjPathWords_ words per object
+    unsigned int trigObjPathWords_ = 0;
+    std::vector<uint64_t> trigObjPathBits_;
+    std::map<std::string, std::vector<unsigned int> > trigObjsByPath_;
   };
 
   math::XYZTLorentzVector getLVFromPtPhi(const double pt, const double phi);
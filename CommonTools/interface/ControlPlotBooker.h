@@ -0,0 +1,75 @@
+#ifndef CATTools_CommonTools_ControlPlotBooker_H
+#define CATTools_CommonTools_ControlPlotBooker_H
+
+#include "CommonTools/Utils/interface/TFileDirectory.h"
+
+#include <string>
+#include <vector>
+
+namespace cat {
+
+// Deferred booking of 1D control plots.
+// Histograms are registered with their binning only, the fills are accumulated
+// in a single buffer shared by all histograms of the booker where the bins of
+// a histogram are allocated at its first fill. The TH1D objects are created
+// by write(), typically at endJob, with the same contents and statistics as
+// if they were booked up front and filled directly.
+// Histograms in a disabled group are never filled nor written.
+class ControlPlotBooker
+{
+public:
+  class H1
+  {
+  public:
+    H1(): booker_(nullptr), index_(-1) {}
+    void Fill(const double x, const double w = 1) { if ( index_ >= 0 ) booker_->fill(index_, x, w); }
+    bool isEnabled() const { return index_ >= 0; }
+
+  private:
+    friend class ControlPlotBooker;
+    H1(ControlPlotBooker* booker, const int index): booker_(booker), index_(index) {}
+
+    ControlPlotBooker* booker_;
+    int index_;
+  };
+
+  void setDisabledGroups(const std::vector<std::string>& groups) { disabledGroups_ = groups; }
+  bool isDisabled(const std::string& group) const;
+
+  H1 book(const TFileDirectory& dir, const std::string& group,
+          const std::string& name, const std::string& title,
+          const int nbins, const double xmin, const double xmax);
+  void fill(const int index, const double x, const double w);
+
+  // Create TH1D of all registered histograms in their directories
+  void write();
+
+  int nBooked() const { return entries_.size(); }
+  int nFilled() const { return nFilled_; }
+  // Size of the fill buffer in bytes
+  size_t bufferSize() const { return buffer_.size()*sizeof(double); }
+
+private:
+  struct Entry
+  {
+    int dirIndex;
+    std::string name, title;
+    int nbins;
+    double xmin, xmax;
+    int offset; // position of the bins in buffer_, -1 before the first fill
+    double entries;
+    bool isWeighted;
+    double stats[4]; // sumw, sumw2, sumwx, sumwx2 of the in-range fills, same as TH1::GetStats()
+  };
+
+  std::vector<std::string> disabledGroups_;
+  std::vector<TFileDirectory> dirs_;
+  std::vector<Entry> entries_;
+  std::vector<double> buffer_; // (sumw, sumw2) pairs for bins 0..nbins+1 of each filled histogram
+  int nFilled_ = 0;
+
+};
+
+}
+
+#endif
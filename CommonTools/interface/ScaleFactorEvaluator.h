@@ -15,12 +15,25 @@ public:
   double operator()(const double x, const double y, const double shift = 0) const;
   double getScaleFactor(const cat::Particle& p, const int pid, const double shift = 0) const;
 
+  // Value and error from a single bin lookup, (1,0) if out of range
+  std::pair<double, double> valueAndError(const double x, const double y) const;
+
 private:
+  // Uniform binning along one axis, detected in set() to replace the binary search
+  struct Axis {
+    bool isUniform = false;
+    double min = 0, invWidth = 0;
+    void set(const std::vector<double>& bins);
+    int find(const std::vector<double>& bins, const double x) const;
+  };
+  int findBin(const double x, const double y) const;
+
   std::vector<double> xbins_, ybins_;
   std::vector<double> values_;
   std::vector<double> errors_;
 
   int width_;
+  Axis xaxis_, yaxis_;
 };
 
 }
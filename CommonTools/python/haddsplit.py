@@ -1,31 +1,127 @@
 #!/usr/bin/env python
 
 import os
+import subprocess
+import heapq
 
-def haddsplit(srcDir, inputFiles, destDir):
+def binpack(inputFiles, nOutput):
+    ## Distribute files to nOutput chunks with balanced total size,
+    ## putting the largest remaining file to the smallest chunk
+    sizes = dict((f, os.stat(f).st_size) for f in inputFiles)
+    heap = [(0, i, []) for i in range(nOutput)]
+    for f in sorted(inputFiles, key=lambda x: sizes[x], reverse=True):
+        size, i, files = heapq.heappop(heap)
+        files.append(f)
+        heapq.heappush(heap, (size+sizes[f], i, files))
+
+    ## Keep the input order within a chunk
+    order = dict((f, i) for i, f in enumerate(inputFiles))
+    chunks = [sorted(files, key=lambda x: order[x]) for size, i, files in sorted(heap, key=lambda x: x[1])]
+    return [x for x in chunks if len(x) > 0]
+
+def countEntries(fileName):
+    ## Number of entries of every TTree in the file, keyed by its path
+    import ROOT
+    f = ROOT.TFile.Open(fileName)
+    if not f or f.IsZombie(): return None
+
+    entries = {}
+    def walk(d, path):
+        for name in set(key.GetName() for key in d.GetListOfKeys()):
+            obj = d.Get(name)
+            if obj.InheritsFrom("TTree"): entries[path+name] = obj.GetEntries()
+            elif obj.InheritsFrom("TDirectory"): walk(obj, path+name+'/')
+    walk(f, '')
+    f.Close()
+
+    return entries
+
+def tmpFileName(outFile):
+    ## Chunks are written under this name and renamed once all of them are verified
+    return outFile[:-len('.root')]+'.tmp.root'
+
+def mergeChunk(args):
+    ## Merge one chunk with hadd into its temporary file and compare the number of entries with the inputs.
+    ## Option -ff keeps the compression of the inputs so that trees with the same
+    ## schema are merged by fast cloning, hadd falls back to the slow merge otherwise.
+    outFile, inputFiles = args
+    tmpFile = tmpFileName(outFile)
+    if os.path.exists(tmpFile): os.remove(tmpFile) ## left over by an interrupted merge
+
+    cmd = ['hadd', '-ff', tmpFile] + inputFiles
+    with open(os.devnull, 'w') as devnull:
+        retVal = subprocess.call(cmd, stdout=devnull)
+    if retVal != 0: return outFile, False, "hadd returned %d" % retVal
+
+    expected = {}
+    for f in inputFiles:
+        entries = countEntries(f)
+        if entries is None: return outFile, False, "cannot open input %s" % f
+        for key, n in entries.iteritems(): expected[key] = expected.get(key, 0) + n
+
+    merged = countEntries(tmpFile)
+    if merged is None: return outFile, False, "cannot open output"
+    for key, n in expected.iteritems():
+        if merged.get(key, -1) != n:
+            return outFile, False, "entries of %s mismatch, %d in inputs, %d in output" % (key, n, merged.get(key, -1))
+
+    return outFile, True, ""
+
+def haddsplit(srcDir, inputFiles, destDir, nWorkers=1, maxSize=4*1024.*1024*1024):
     if os.path.exists(destDir) and len(os.listdir(destDir)) > 1:
         print "Directory", destDir, "is not empty. skip."
         return False
     if not os.path.exists(destDir): os.makedirs(destDir)
 
-    ## estimate total size and merge not to exceed 1Gbytes
+    ## estimate total size and merge not to exceed maxSize, 4Gbytes by default
     totalSize = sum([os.stat(f).st_size for f in inputFiles])
-    fSize = 4*1024.*1024*1024 # 4GB
-    nOutput = int(totalSize/fSize)+1
-
-    nTotalFiles = len(inputFiles)
-    nFiles = nTotalFiles/nOutput
+    nOutput = int(totalSize/maxSize)+1
 
     prefix = '.'.join(os.path.basename(inputFiles[0]).split('.')[:-1])
     if '_' in prefix and prefix.split('_')[-1].isdigit():
         prefix = '_'.join(prefix.split('_')[:-1])
 
-    for i in range(nOutput):
-        cmd = 'hadd -f %s/%s_%d.root ' % (destDir, prefix, i)
-        if i == nOutput-1: cmd += ' '.join(inputFiles[i*nFiles:])
-        else: cmd += ' '.join(inputFiles[i*nFiles:(i+1)*nFiles])
-        os.system(cmd)
-    for x in inputFiles: os.system("rm -f %s" % (x))
+    jobs = []
+    for i, files in enumerate(binpack(inputFiles, nOutput)):
+        jobs.append(('%s/%s_%d.root' % (destDir, prefix, i), files))
+
+    ## Workers cannot be forked from a daemonic process, i.e. if haddsplit is called from a Pool.
+    ## Keep nWorkers=1 in that case.
+    if nWorkers > 1 and len(jobs) > 1:
+        from multiprocessing import Pool
+        pool = Pool(min(nWorkers, len(jobs)))
+        results = pool.map(mergeChunk, jobs)
+        pool.close()
+        pool.join()
+    else:
+        results = [mergeChunk(job) for job in jobs]
+
+    isOK = True
+    for outFile, ok, msg in results:
+        if ok: continue
+        print "!!! Failed to merge", outFile, ":", msg
+        isOK = False
+    if not isOK:
+        ## Remove every output of this call, so that destDir is left as it was and can be retried
+        for outFile, files in jobs:
+            if os.path.exists(tmpFileName(outFile)): os.remove(tmpFileName(outFile))
+        print "!!! Keeping input files in", srcDir
+        return False
+
+    for outFile, files in jobs: os.rename(tmpFileName(outFile), outFile)
+    for x in inputFiles: os.remove(x)
 
     return True
 
+if __name__ == '__main__':
+    import sys, argparse
+    parser = argparse.ArgumentParser(description="Merge root files into chunks of balanced size and remove the inputs")
+    parser.add_argument('-o', '--outDir', required=True, help="Output directory")
+    parser.add_argument('-j', '--jobs', type=int, default=1, help="Number of parallel merging jobs")
+    parser.add_argument('-s', '--maxSize', type=float, default=4, help="Maximum output size in GBytes")
+    parser.add_argument('inputFiles', nargs='+')
+    args = parser.parse_args()
+
+    srcDir = os.path.dirname(args.inputFiles[0])
+    isOK = haddsplit(srcDir, args.inputFiles, args.outDir, args.jobs, args.maxSize*1024.*1024*1024)
+    if not isOK: sys.exit(1)
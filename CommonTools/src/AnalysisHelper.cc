@@ -29,9 +29,52 @@ namespace cat
     return;
   }
 
+  void TriggerPathIndex::update(const edm::TriggerNames& triggerNames)
+  {
+    triggerNames_ = &triggerNames;
+    if ( triggerNames.parameterSetID() == psetID_ ) return;
+
+    psetID_ = triggerNames.parameterSetID();
+    for ( int i=0, n=patterns_.size(); i<n; ++i ) resolve(i);
+  }
+
+  int TriggerPathIndex::handle(const std::string& pattern, const bool prefixOnly)
+  {
+    const auto key = std::make_pair(pattern, prefixOnly);
+    auto itr = handles_.find(key);
+    if ( itr != handles_.end() ) return itr->second;
+
+    const int h = patterns_.size();
+    handles_[key] = h;
+    patterns_.push_back(pattern);
+    prefixOnly_.push_back(prefixOnly);
+    paths_.push_back(std::vector<unsigned int>());
+    if ( triggerNames_ ) resolve(h);
+    return h;
+  }
+
+  void TriggerPathIndex::resolve(const int handle)
+  {
+    auto& paths = paths_[handle];
+    paths.clear();
+    for ( unsigned int i=0, n=triggerNames_->size(); i<n; ++i ) {
+      const size_t pos = triggerNames_->triggerName(i).find(patterns_[handle]);
+      if ( prefixOnly_[handle] ? pos == 0 : pos != std::string::npos ) paths.push_back(i);
+    }
+  }
+
+  bool TriggerPathIndex::fired(const int handle, const edm::TriggerResults& triggerResults) const
+  {
+    for ( const unsigned int i : paths_[handle] ) {
+      if ( i < triggerResults.size() and triggerResults.accept(i) ) return true;
+    }
+    return false;
+  }
+
   bool AnalysisHelper::triggerFired(const std::string& trigname)
   {
     if (!triggerInfoSet_) return triggerNotSet();
+    if (pathIndex_) return pathIndex_->fired(pathIndex_->handle(trigname), *triggerResults_);
 
     const unsigned int ntrigs = triggerResults_->size();
     for (unsigned int itr=0; itr<ntrigs; itr++){
@@ -42,24 +85,70 @@ namespace cat
     return false;
   }
 
+  void AnalysisHelper::unpackTriggerObjects()
+  {
+    triggerObjectsUnpacked_ = true;
+
+    const unsigned int nObjs = triggerObjects_->size();
+    const unsigned int nPaths = triggerNames_.size();
+    trigObjEtas_.reserve(nObjs);
+    trigObjPhis_.reserve(nObjs);
+    trigObjPathWords_ = (nPaths+63)/64;
+    trigObjPathBits_.assign(nObjs*trigObjPathWords_, 0);
+    // The packed path indices are not accessible, so each object is still assigned to a scratch
+    // object to be unpacked. Reusing it keeps the capacity of its vectors from one object to the next.
+    pat::TriggerObjectStandAlone trigObj;
+    for (unsigned int i = 0; i < nObjs; ++i) {
+      trigObj = (*triggerObjects_)[i];
+      trigObj.unpackPathNames(triggerNames_);
+      trigObjEtas_.push_back(trigObj.eta());
+      trigObjPhis_.push_back(trigObj.phi());
+      uint64_t* bits = &trigObjPathBits_[i*trigObjPathWords_];
+      for (const std::string& pathName : trigObj.pathNames(false)) {
+        if (!trigObj.hasPathName( pathName, true, true )) continue;
+        const unsigned int index = triggerNames_.triggerIndex(pathName);
+        if ( index < nPaths ) bits[index/64] |= uint64_t(1) << (index%64);
+      }
+    }
+  }
+
+  std::vector<unsigned int> AnalysisHelper::pathsWithPrefix(const std::string& trigname)
+  {
+    if (pathIndex_) return pathIndex_->paths(pathIndex_->handle(trigname, true));
+
+    std::vector<unsigned int> paths;
+    for (unsigned int i = 0, n = triggerNames_.size(); i < n; ++i) {
+      if ( triggerNames_.triggerName(i).find(trigname) == 0 ) paths.push_back(i);
+    }
+    return paths;
+  }
+
+  const std::vector<unsigned int>& AnalysisHelper::triggerObjectsForPath(const std::string& trigname)
+  {
+    auto itr = trigObjsByPath_.find(trigname);
+    if ( itr != trigObjsByPath_.end() ) return itr->second;
+
+    if (!triggerObjectsUnpacked_) unpackTriggerObjects();
+    const std::vector<unsigned int> paths = pathsWithPrefix(trigname);
+    std::vector<unsigned int>& objs = trigObjsByPath_[trigname];
+    for (unsigned int i = 0, n = trigObjEtas_.size(); i < n; ++i) {
+      const uint64_t* bits = &trigObjPathBits_[i*trigObjPathWords_];
+      for (const unsigned int index : paths) {
+        if ( bits[index/64] & (uint64_t(1) << (index%64)) ) { objs.push_back(i); break; }
+      }
+    }
+    return objs;
+  }
+
   bool AnalysisHelper::triggerMatched(const std::string& trigname, const cat::Particle & recoObj, const float dR)
   {
     if (!triggerInfoSet_) return triggerNotSet();
 
-    for (pat::TriggerObjectStandAlone trigObj : *triggerObjects_) { // note: not "const &" since we want to call unpackPathNames
-      trigObj.unpackPathNames(triggerNames_);
-      std::vector<std::string> pathNamesAll  = trigObj.pathNames(false);
-      for (unsigned h = 0, n = pathNamesAll.size(); h < n; ++h) {
-	if ( pathNamesAll[h].find(trigname) == 0 ){
-	  if (trigObj.hasPathName( pathNamesAll[h], true, true )){
-	    // found trigger
-	    if ( reco::deltaR(trigObj, recoObj) < dR){
-	      // found matching trigger
-	      //std::cout << "\tTrigger trigObject:  pt " << trigObj.pt() << ", eta " << trigObj.eta() << ", phi " << trigObj.phi() << std::endl;
-	      return true;
-	    }
-	  }
-	}
+    const double recoEta = recoObj.eta(), recoPhi = recoObj.phi();
+    for (const unsigned int i : triggerObjectsForPath(trigname)) {
+      if ( reco::deltaR(trigObjEtas_[i], trigObjPhis_[i], recoEta, recoPhi) < dR ) {
+        // found matching trigger
+        return true;
       }
     }
     return false;
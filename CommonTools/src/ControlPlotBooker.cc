@@ -0,0 +1,88 @@
+#include "CATTools/CommonTools/interface/ControlPlotBooker.h"
+#include "TH1D.h"
+#include <algorithm>
+
+using namespace cat;
+
+bool ControlPlotBooker::isDisabled(const std::string& group) const
+{
+  return std::find(disabledGroups_.begin(), disabledGroups_.end(), group) != disabledGroups_.end();
+}
+
+ControlPlotBooker::H1 ControlPlotBooker::book(const TFileDirectory& dir, const std::string& group,
+                                              const std::string& name, const std::string& title,
+                                              const int nbins, const double xmin, const double xmax)
+{
+  if ( isDisabled(group) ) return H1();
+
+  // Histograms are registered directory by directory, compare with the last one only
+  if ( dirs_.empty() or dirs_.back().fullPath() != dir.fullPath() ) dirs_.push_back(dir);
+
+  Entry e;
+  e.dirIndex = dirs_.size()-1;
+  e.name = name;
+  e.title = title;
+  e.nbins = nbins;
+  e.xmin = xmin;
+  e.xmax = xmax;
+  e.offset = -1;
+  e.entries = 0;
+  e.isWeighted = false;
+  std::fill(e.stats, e.stats+4, 0.);
+  entries_.push_back(e);
+
+  return H1(this, entries_.size()-1);
+}
+
+void ControlPlotBooker::fill(const int index, const double x, const double w)
+{
+  auto& e = entries_[index];
+  if ( e.offset < 0 ) {
+    e.offset = buffer_.size();
+    buffer_.resize(buffer_.size()+2*(e.nbins+2));
+    ++nFilled_;
+  }
+
+  // Same bin finding as TAxis::FindFixBin, NaN goes to the overflow
+  int bin;
+  if ( x < e.xmin ) bin = 0;
+  else if ( !(x < e.xmax) ) bin = e.nbins+1;
+  else bin = 1 + int(e.nbins*(x-e.xmin)/(e.xmax-e.xmin));
+
+  double* p = &buffer_[e.offset+2*bin];
+  p[0] += w;
+  p[1] += w*w;
+
+  // Follow TH1::Fill for the entries and statistics
+  e.entries += 1;
+  if ( w != 1 ) e.isWeighted = true;
+  if ( bin == 0 or bin == e.nbins+1 ) return;
+  e.stats[0] += w;
+  e.stats[1] += w*w;
+  e.stats[2] += w*x;
+  e.stats[3] += w*x*x;
+}
+
+void ControlPlotBooker::write()
+{
+  for ( auto& e : entries_ ) {
+    auto h = dirs_[e.dirIndex].make<TH1D>(e.name.c_str(), e.title.c_str(), e.nbins, e.xmin, e.xmax);
+    if ( e.offset < 0 ) continue;
+
+    // TH1::Fill enables Sumw2 at the first weighted fill
+    if ( e.isWeighted ) h->Sumw2();
+    const double* p = &buffer_[e.offset];
+    for ( int bin=0; bin<=e.nbins+1; ++bin, p += 2 ) {
+      h->SetBinContent(bin, p[0]);
+      if ( e.isWeighted ) h->GetSumw2()->SetAt(p[1], bin);
+    }
+    // SetBinContent resets the statistics, put them back at the end
+    h->PutStats(e.stats);
+    h->SetEntries(e.entries);
+  }
+
+  // Everything is in the TH1D now, release the buffer
+  std::vector<double>().swap(buffer_);
+  for ( auto& e : entries_ ) e.offset = -1;
+  nFilled_ = 0;
+}
@@ -1,5 +1,6 @@
 #include "CATTools/CommonTools/interface/ScaleFactorEvaluator.h"
 #include <cassert>
+#include <cmath>
 
 using namespace cat;
 
@@ -20,44 +21,69 @@ void ScaleFactorEvaluator::set(const std::vector<double>& xbins,
 
   // For cache
   width_ = xbins_.size()-1;
+  xaxis_.set(xbins_);
+  yaxis_.set(ybins_);
 }
 
-double ScaleFactorEvaluator::operator()(const double x, const double y, const double shift) const
+void ScaleFactorEvaluator::Axis::set(const std::vector<double>& bins)
 {
-  auto xbin = std::lower_bound(xbins_.begin(), xbins_.end(), x);
-  if ( xbin == xbins_.end() or xbin+1 == xbins_.end() ) return 1;
-  auto ybin = std::lower_bound(ybins_.begin(), ybins_.end(), y);
-  if ( ybin == ybins_.end() or ybin+1 == ybins_.end() ) return 1;
+  isUniform = false;
+  min = invWidth = 0;
+  const int n = bins.size();
+  if ( n < 2 ) return;
 
-  const int column = xbin-xbins_.begin();
-  const int row = ybin-ybins_.begin();
+  const double width = (bins.back()-bins.front())/(n-1);
+  if ( width <= 0 ) return;
+  for ( int i=1; i<n; ++i ) {
+    if ( std::abs(bins[i]-bins[i-1]-width) > 1e-9*width ) return;
+  }
+  isUniform = true;
+  min = bins.front();
+  invWidth = 1./width;
+}
 
-  const int bin = row*width_+column;
-  const double value = values_.at(bin);
-  const double error = errors_.at(bin);
+// Same result as std::lower_bound, i.e. the index of the first edge not less than x
+int ScaleFactorEvaluator::Axis::find(const std::vector<double>& bins, const double x) const
+{
+  const int n = bins.size();
+  if ( !isUniform ) return std::lower_bound(bins.begin(), bins.end(), x)-bins.begin();
 
-  return std::max(0.0, value+shift*error);
+  // Guess from the index arithmetic, then fix rounding against the actual edges
+  const double fi = std::ceil((x-min)*invWidth);
+  int i = !(fi > 0) ? 0 : fi > n ? n : int(fi);
+  while ( i > 0 and bins[i-1] >= x ) --i;
+  while ( i < n and bins[i] < x ) ++i;
+  return i;
+}
+
+int ScaleFactorEvaluator::findBin(const double x, const double y) const
+{
+  const int column = xaxis_.find(xbins_, x);
+  if ( column+1 >= int(xbins_.size()) ) return -1;
+  const int row = yaxis_.find(ybins_, y);
+  if ( row+1 >= int(ybins_.size()) ) return -1;
+
+  return row*width_+column;
+}
+
+std::pair<double, double> ScaleFactorEvaluator::valueAndError(const double x, const double y) const
+{
+  const int bin = findBin(x, y);
+  if ( bin < 0 ) return std::make_pair(1., 0.);
+  return std::make_pair(values_[bin], errors_[bin]);
+}
+
+double ScaleFactorEvaluator::operator()(const double x, const double y, const double shift) const
+{
+  const int bin = findBin(x, y);
+  if ( bin < 0 ) return 1;
+
+  return std::max(0.0, values_[bin]+shift*errors_[bin]);
 }
 
 double ScaleFactorEvaluator::getScaleFactor(const cat::Particle& p, const int pid, const double shift) const
 {
   const int aid = abs(p.pdgId());
-  if ( aid == pid ) {
-    const double x = p.pt(), y = p.eta();
-    
-    auto xbin = std::lower_bound(xbins_.begin(), xbins_.end(), x);
-    if ( xbin == xbins_.end() or xbin+1 == xbins_.end() ) return 1;
-    auto ybin = std::lower_bound(ybins_.begin(), ybins_.end(), y);
-    if ( ybin == ybins_.end() or ybin+1 == ybins_.end() ) return 1;
-
-    const int column = xbin-xbins_.begin();
-    const int row = ybin-ybins_.begin();
-
-    const int bin = row*width_+column;
-    const double value = values_.at(bin);
-    const double error = errors_.at(bin);
-
-    return std::max(0.0, value+shift*error);
-  }
+  if ( aid == pid ) return (*this)(p.pt(), p.eta(), shift);
   return 1;
 }
@@ -0,0 +1,105 @@
+// ScaleFactorEvaluator must give the same scale factors as the former std::lower_bound lookup,
+// on uniform and non-uniform binnings, at and next to every bin edge, out of range and for NaN.
+
+#include "CATTools/CommonTools/interface/ScaleFactorEvaluator.h"
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+
+using namespace cat;
+
+namespace {
+  // The lookup as it was before the uniform binning shortcut, value and error or (1,0) out of range
+  std::pair<double, double> lowerBoundLookup(const std::vector<double>& xbins, const std::vector<double>& ybins,
+                                             const std::vector<double>& values, const std::vector<double>& errors,
+                                             const double x, const double y)
+  {
+    auto xbin = std::lower_bound(xbins.begin(), xbins.end(), x);
+    if ( xbin == xbins.end() or xbin+1 == xbins.end() ) return std::make_pair(1., 0.);
+    auto ybin = std::lower_bound(ybins.begin(), ybins.end(), y);
+    if ( ybin == ybins.end() or ybin+1 == ybins.end() ) return std::make_pair(1., 0.);
+
+    const int bin = (ybin-ybins.begin())*(xbins.size()-1) + (xbin-xbins.begin());
+    return std::make_pair(values.at(bin), errors.at(bin));
+  }
+
+  // Edges, their neighbouring doubles, points outside the range and NaN
+  std::vector<double> specialPoints(const std::vector<double>& bins)
+  {
+    std::vector<double> points = {std::numeric_limits<double>::quiet_NaN(), -1e9, 1e9,
+                                  bins.front()-1, bins.back()+1};
+    for ( const double b : bins ) {
+      points.push_back(b);
+      points.push_back(std::nextafter(b, -1e300));
+      points.push_back(std::nextafter(b, +1e300));
+    }
+    return points;
+  }
+}
+
+int main()
+{
+  std::mt19937 rnd(4357);
+  std::uniform_real_distribution<double> flat(0, 1);
+
+  std::vector<double> ptUniform, etaUniform, absEtaUniform;
+  for ( int i=0; i<=10; ++i ) ptUniform.push_back(20+i*10.);
+  for ( int i=0; i<=24; ++i ) etaUniform.push_back(-2.4+i*0.2);
+  for ( int i=0; i<=6; ++i ) absEtaUniform.push_back(i*0.4);
+  const std::vector<double> ptVariable = {20, 25, 30, 40, 50, 60, 120, 200};
+  const std::vector<double> etaVariable = {0, 0.9, 1.2, 2.1, 2.4};
+
+  const std::vector<std::pair<std::vector<double>, std::vector<double> > > binnings = {
+    {ptUniform, etaUniform}, {ptVariable, etaUniform}, {ptUniform, etaVariable},
+    {ptVariable, etaVariable}, {ptUniform, absEtaUniform}, {ptVariable, absEtaUniform},
+  };
+  const std::vector<double> shifts = {0, 1, -1, 2.5, -30};
+
+  int nBad = 0, nCompared = 0;
+  for ( const auto& binning : binnings ) {
+    const auto& xbins = binning.first;
+    const auto& ybins = binning.second;
+    std::vector<double> values, errors;
+    for ( size_t i=0; i<(xbins.size()-1)*(ybins.size()-1); ++i ) {
+      values.push_back(0.9+0.2*flat(rnd));
+      errors.push_back(0.05*flat(rnd));
+    }
+    ScaleFactorEvaluator sf;
+    sf.set(xbins, ybins, values, errors);
+
+    std::vector<std::pair<double, double> > points;
+    for ( const double x : specialPoints(xbins) ) {
+      for ( const double y : specialPoints(ybins) ) points.push_back(std::make_pair(x, y));
+    }
+    for ( int i=0; i<100000; ++i ) points.push_back(std::make_pair(-10+250*flat(rnd), -3+6*flat(rnd)));
+
+    for ( const auto& point : points ) {
+      const double x = point.first, y = point.second;
+      const auto expected = lowerBoundLookup(xbins, ybins, values, errors, x, y);
+      ++nCompared;
+      if ( sf.valueAndError(x, y) != expected ) {
+        std::cout << "valueAndError(" << x << ", " << y << ") differs" << std::endl;
+        ++nBad;
+      }
+      for ( const double shift : shifts ) {
+        ++nCompared;
+        if ( sf(x, y, shift) != std::max(0.0, expected.first+shift*expected.second) ) {
+          std::cout << "scale factor (" << x << ", " << y << ", " << shift << ") differs" << std::endl;
+          ++nBad;
+        }
+      }
+    }
+
+    // Beyond the last edge the scale factor is 1 whatever the shift
+    for ( const double shift : shifts ) {
+      nCompared += 2;
+      if ( sf(xbins.back()+1, ybins[1], shift) != 1 ) ++nBad;
+      if ( sf(xbins[1], ybins.back()+1, shift) != 1 ) ++nBad;
+    }
+  }
+
+  std::cout << nBad << " of " << nCompared << " scale factors differ from the lower_bound lookup" << std::endl;
+  return nBad == 0 ? 0 : 1;
+}
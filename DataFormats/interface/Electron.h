@@ -25,6 +25,13 @@ namespace cat {
 
     float electronID(const std::string& name) const;
     float electronID(const char* name) const { return electronID( std::string(name) );}
+    // Position of the first ID containing name, -1 if not found.
+    // Electrons from the same producer share the ID ordering, so the index can be
+    // resolved once from any electron of the collection and reused for all of them.
+    int electronIDIndex(const std::string& name) const;
+    // Same as electronIDIndex, throwing the 'Key not found' exception with the name if it is not found
+    int checkedElectronIDIndex(const std::string& name) const;
+    float electronID(const int index) const;
     bool isVeto() const {return electronID("veto");}
     bool isMediumMVA() const {return electronID("wp90");}
     bool isTightMVA() const {return electronID("wp80");}
@@ -73,6 +80,8 @@ namespace cat {
     float scaleFactor(const std::string& name, int sign = 0) const;
     
   private:
+    void throwIDNotFound(const std::string& name) const;
+
 
     std::vector<pat::Electron::IdPair> electronIDs_;
 
@@ -78,6 +78,13 @@ namespace cat {
     const reco::GenJet * genJet() const { return genJetFwdRef_.get();}
 
     float bDiscriminator(const std::string &theLabel) const;
+    // Position of the label in the discriminator list, -1 if not available.
+    // Jets from the same producer share the label ordering, so the index can be
+    // resolved once from any jet of the collection and reused for all of them.
+    int bDiscriminatorIndex(const std::string &theLabel) const;
+    float bDiscriminator(const int index) const {
+      return (index < 0 or index >= int(pairDiscriVector_.size())) ? -1000. : pairDiscriVector_[index].second;
+    }
     const std::vector<std::pair<std::string, float> > & getPairDiscri() const {return pairDiscriVector_; }
 
     bool CSVv2L(){ return (bDiscriminator(BTAG_CSVv2) > WP_BTAG_CSVv2L);}
@@ -20,7 +20,7 @@ public:
   int index(const std::string& name) const;
   std::string name(const size_t i) const { return names_.at(i); }
   size_t size() const { return names_.size(); }
-  std::vector<std::string> names() const { return names_; }
+  const std::vector<std::string>& names() const { return names_; }
 
   int print() const;
 
@@ -42,12 +42,21 @@ public:
   void set(const TriggerResValues& results);
 
   // Getters
-  unsigned short result(const int i) const { return values_.at(i); } 
-  std::vector<unsigned short> values() const { return values_; }
+  unsigned short result(const int i) const;
+  std::vector<unsigned short> values() const;
+  size_t size() const { return values_.empty() ? nPaths_ : values_.size(); }
 
 private:
+  // One value per path, only filled in files written before the packed format
   std::vector<unsigned short> values_;
 
+  // Packed format: one accept bit per path and a sparse list of the
+  // prescale values of accepted paths with prescale != 1, sorted by index
+  unsigned int nPaths_;
+  std::vector<unsigned int> acceptBits_;
+  std::vector<unsigned short> psIndices_;
+  std::vector<unsigned short> psValues_;
+
 };
 
 }
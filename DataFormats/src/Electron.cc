@@ -25,10 +25,28 @@ Electron::~Electron() {
 }
 
 float Electron::electronID(const std::string& name) const {
-  for (std::vector<pat::Electron::IdPair>::const_iterator it = electronIDs_.begin(), ed = electronIDs_.end(); it != ed; ++it) {
-    if (it->first.find(name) != std::string::npos)
-      return it->second;
+  return electronIDs_[checkedElectronIDIndex(name)].second;
+}
+
+int Electron::electronIDIndex(const std::string& name) const {
+  for ( int i=0, n=electronIDs_.size(); i<n; ++i ) {
+    if (electronIDs_[i].first.find(name) != std::string::npos) return i;
   }
+  return -1;
+}
+
+int Electron::checkedElectronIDIndex(const std::string& name) const {
+  const int index = electronIDIndex(name);
+  if ( index < 0 ) throwIDNotFound(name);
+  return index;
+}
+
+float Electron::electronID(const int index) const {
+  if ( index < 0 or index >= int(electronIDs_.size()) ) throwIDNotFound("with index "+std::to_string(index));
+  return electronIDs_[index].second;
+}
+
+void Electron::throwIDNotFound(const std::string& name) const {
   cms::Exception ex("Key not found");
   ex << "cat::Electron: the ID " << name << " can't be found in this cat::Electron.\n";
   ex << "The available IDs are: ";
@@ -35,14 +35,17 @@ Jet::~Jet() {
 
 /// get b discriminant from label name
 float Jet::bDiscriminator(const std::string & aLabel) const {
-  float discriminator = -1000.;
+  return bDiscriminator(bDiscriminatorIndex(aLabel));
+}
+
+/// get position of the b discriminant in the list from label name
+int Jet::bDiscriminatorIndex(const std::string & aLabel) const {
   const std::string & theLabel = ((aLabel == "" || aLabel == "default")) ? "trackCountingHighEffBJetTags" : aLabel;
-  for(unsigned int i=0; i!=pairDiscriVector_.size(); i++){
-    if(pairDiscriVector_[i].first == theLabel){
-      discriminator = pairDiscriVector_[i].second;
-    }
+  // Search backward to keep the last entry in case of duplicated labels
+  for(int i=int(pairDiscriVector_.size())-1; i>=0; --i){
+    if(pairDiscriVector_[i].first == theLabel) return i;
   }
-  return discriminator;
+  return -1;
 }
 
 /// print all bjet Discriminators
@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <algorithm>
+#include <stdexcept>
 
 using namespace cat;
 using namespace std;
@@ -32,14 +33,49 @@ int TriggerNames::print() const
   return 0;
 }
 
-TriggerBits::TriggerBits()
+TriggerBits::TriggerBits():
+  nPaths_(0)
 {
 }
 
 void TriggerBits::set(const cat::TriggerResValues& results)
 {
-  for ( auto key = results.begin(); key != results.end(); ++key ) {
-    values_.push_back(key->second);
+  values_.clear();
+  nPaths_ = results.size();
+  acceptBits_.assign((nPaths_+31)/32, 0);
+  psIndices_.clear();
+  psValues_.clear();
+
+  unsigned int index = 0;
+  for ( auto key = results.begin(); key != results.end(); ++key, ++index ) {
+    const unsigned short value = key->second;
+    if ( value == 0 ) continue;
+
+    acceptBits_[index/32] |= 1u << (index%32);
+    if ( value != 1 ) {
+      psIndices_.push_back(index);
+      psValues_.push_back(value);
+    }
   }
 }
 
+unsigned short TriggerBits::result(const int i) const
+{
+  if ( !values_.empty() ) return values_.at(i);
+
+  if ( i < 0 or i >= int(nPaths_) ) throw std::out_of_range("cat::TriggerBits::result");
+  if ( !(acceptBits_[i/32] & (1u << (i%32))) ) return 0;
+
+  auto match = std::lower_bound(psIndices_.begin(), psIndices_.end(), i);
+  if ( match == psIndices_.end() or *match != i ) return 1;
+  return psValues_[match-psIndices_.begin()];
+}
+
+std::vector<unsigned short> TriggerBits::values() const
+{
+  if ( !values_.empty() ) return values_;
+
+  std::vector<unsigned short> values(nPaths_);
+  for ( int i=0, n=nPaths_; i<n; ++i ) values[i] = result(i);
+  return values;
+}
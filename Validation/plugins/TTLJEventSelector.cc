@@ -10,6 +10,7 @@
 
 #include "CATTools/CommonTools/interface/TTbarModeDefs.h"
 #include "CATTools/CommonTools/interface/ScaleFactorEvaluator.h"
+#include "CATTools/CommonTools/interface/ControlPlotBooker.h"
 #include "CATTools/CatAnalyzer/interface/TopTriggerSF.h"
 
 #include "DataFormats/Candidate/interface/LeafCandidate.h"
@@ -36,12 +37,12 @@ struct ControlPlotsTTLJ
     "step5a", "step5b", "step5c", "step5d", "step6"
   };
 
-  typedef TH1D* H1;
+  typedef cat::ControlPlotBooker::H1 H1;
   typedef TH2D* H2;
 
   bool isBooked;
 
-  H1 hCutstep, hCutstepNoweight;
+  TH1D* hCutstep, * hCutstepNoweight;
   H2 h2Cutstep, h2CutstepNoweight;
 
   H1 h_vertex_n[nCutstep];
@@ -64,7 +65,7 @@ struct ControlPlotsTTLJ
   H1 h_event_mjj[nCutstep]; // Dijet mass with largest pT
   H1 h_event_m3[nCutstep]; // M3, find a combination of dijet+bjet with largest pT
 
-  void book(TFileDirectory&& dir)
+  void book(TFileDirectory&& dir, ControlPlotBooker& booker)
   {
     const double maxeta = 3;
     const double pi = 3.141592;
@@ -93,41 +94,41 @@ struct ControlPlotsTTLJ
     }
 
     auto subdir = dir.mkdir(stepNames[0]);
-    h_vertex_n[0] = subdir.make<TH1D>("vertex_n", "vertex_n;Number of primary vertices;Events;Vertex multipliity;Events", 100, 0, 100);
+    h_vertex_n[0] = booker.book(subdir, "vertex", "vertex_n", "vertex_n;Number of primary vertices;Events;Vertex multipliity;Events", 100, 0, 100);
 
     for ( int i=1; i<=2; ++i ) {
       subdir = dir.mkdir(stepNames[i]);
-      h_vertex_n[i] = subdir.make<TH1D>("vertex_n", "vertex_n;Number of primary vertices;Events", 100, 0, 100);
-      h_met_pt[i] = subdir.make<TH1D>("met_pt", "met_pt;Missing transverse momentum (GeV);Events/1GeV", 1000, 0, 1000);
-      h_met_phi[i] = subdir.make<TH1D>("met_phi", "met_phi;Missing transverse momentum #phi;Events", 100, -pi, pi);
-      h_leptons_n[i] = subdir.make<TH1D>("leptons_n", "leptons_n;Lepton multiplicity;Events", 10, 0, 10);
-      h_lepton1_pt[i]  = subdir.make<TH1D>("lepton1_pt", "lepton1_pt;1st leading lepton p_{T} (GeV);Events/1GeV", 1000, 0, 1000);
-      h_lepton1_eta[i] = subdir.make<TH1D>("lepton1_eta", "lepton1_eta;1st leading lepton #eta;Events", 100, -maxeta, maxeta);
-      h_lepton1_phi[i] = subdir.make<TH1D>("lepton1_phi", "lepton1_phi;1st leading lepton #phi;Events", 100, -pi, pi);
-      h_lepton1_q[i]   = subdir.make<TH1D>("lepton1_q", "lepton1_q;1st leading lepton charge;Events", 3, -1.5, 1.5);
-      h_jets_n[i] = subdir.make<TH1D>("jets_n", "jets_n;Jet multiplicity;Events", 10, 0, 10);
-      h_jets_pt[i]  = subdir.make<TH1D>("jets_pt", "jets_pt;Jets p_{T} (GeV);Events/1GeV", 1000, 0, 1000);
-      h_jets_eta[i] = subdir.make<TH1D>("jets_eta", "jets_eta;Jets #eta;Events", 100, -maxeta, maxeta);
-      h_jets_ht[i] = subdir.make<TH1D>("jets_ht", "jets_ht;Jets #Sigma p_{T} (GeV);Events/1GeV", 1000, 0, 1000);
-      h_bjets_n[i] = subdir.make<TH1D>("bjets_n", "bjets_n;b-jet multiplicity;Events", 10, 0, 10);
+      h_vertex_n[i] = booker.book(subdir, "vertex", "vertex_n", "vertex_n;Number of primary vertices;Events", 100, 0, 100);
+      h_met_pt[i] = booker.book(subdir, "met", "met_pt", "met_pt;Missing transverse momentum (GeV);Events/1GeV", 1000, 0, 1000);
+      h_met_phi[i] = booker.book(subdir, "met", "met_phi", "met_phi;Missing transverse momentum #phi;Events", 100, -pi, pi);
+      h_leptons_n[i] = booker.book(subdir, "leptons", "leptons_n", "leptons_n;Lepton multiplicity;Events", 10, 0, 10);
+      h_lepton1_pt[i] = booker.book(subdir, "lepton1", "lepton1_pt", "lepton1_pt;1st leading lepton p_{T} (GeV);Events/1GeV", 1000, 0, 1000);
+      h_lepton1_eta[i] = booker.book(subdir, "lepton1", "lepton1_eta", "lepton1_eta;1st leading lepton #eta;Events", 100, -maxeta, maxeta);
+      h_lepton1_phi[i] = booker.book(subdir, "lepton1", "lepton1_phi", "lepton1_phi;1st leading lepton #phi;Events", 100, -pi, pi);
+      h_lepton1_q[i] = booker.book(subdir, "lepton1", "lepton1_q", "lepton1_q;1st leading lepton charge;Events", 3, -1.5, 1.5);
+      h_jets_n[i] = booker.book(subdir, "jets", "jets_n", "jets_n;Jet multiplicity;Events", 10, 0, 10);
+      h_jets_pt[i] = booker.book(subdir, "jets", "jets_pt", "jets_pt;Jets p_{T} (GeV);Events/1GeV", 1000, 0, 1000);
+      h_jets_eta[i] = booker.book(subdir, "jets", "jets_eta", "jets_eta;Jets #eta;Events", 100, -maxeta, maxeta);
+      h_jets_ht[i] = booker.book(subdir, "jets", "jets_ht", "jets_ht;Jets #Sigma p_{T} (GeV);Events/1GeV", 1000, 0, 1000);
+      h_bjets_n[i] = booker.book(subdir, "bjets", "bjets_n", "bjets_n;b-jet multiplicity;Events", 10, 0, 10);
     }
 
     for ( int i=3; i<nCutstep; ++i ) {
       subdir = dir.mkdir(stepNames[i]);
-      h_vertex_n[i] = subdir.make<TH1D>("vertex_n", "vertex_n;Number of primary vertices;Events", 100, 0, 100);
-      h_met_pt[i] = subdir.make<TH1D>("met_pt", "met_pt;Missing transverse momentum (GeV);Events/1GeV", 1000, 0, 1000);
-      h_met_phi[i] = subdir.make<TH1D>("met_phi", "met_phi;Missing transverse momentum #phi;Events", 100, -pi, pi);
-      h_leptons_n[i] = subdir.make<TH1D>("leptons_n", "leptons_n;Lepton multiplicity;Events", 10, 0, 10);
+      h_vertex_n[i] = booker.book(subdir, "vertex", "vertex_n", "vertex_n;Number of primary vertices;Events", 100, 0, 100);
+      h_met_pt[i] = booker.book(subdir, "met", "met_pt", "met_pt;Missing transverse momentum (GeV);Events/1GeV", 1000, 0, 1000);
+      h_met_phi[i] = booker.book(subdir, "met", "met_phi", "met_phi;Missing transverse momentum #phi;Events", 100, -pi, pi);
+      h_leptons_n[i] = booker.book(subdir, "leptons", "leptons_n", "leptons_n;Lepton multiplicity;Events", 10, 0, 10);
 
-      h_lepton1_pt[i]  = subdir.make<TH1D>("lepton1_pt", "lepton1_pt;1st leading lepton p_{T} (GeV);Events/1GeV", 1000, 0, 1000);
-      h_lepton1_eta[i] = subdir.make<TH1D>("lepton1_eta", "lepton1_eta;1st leading lepton #eta;Events", 100, -maxeta, maxeta);
-      h_lepton1_phi[i] = subdir.make<TH1D>("lepton1_phi", "lepton1_phi;1st leading lepton #phi;Events", 100, -pi, pi);
-      h_lepton1_q[i]   = subdir.make<TH1D>("lepton1_q", "lepton1_q;1st leading lepton charge;Events", 3, -1.5, 1.5);
+      h_lepton1_pt[i] = booker.book(subdir, "lepton1", "lepton1_pt", "lepton1_pt;1st leading lepton p_{T} (GeV);Events/1GeV", 1000, 0, 1000);
+      h_lepton1_eta[i] = booker.book(subdir, "lepton1", "lepton1_eta", "lepton1_eta;1st leading lepton #eta;Events", 100, -maxeta, maxeta);
+      h_lepton1_phi[i] = booker.book(subdir, "lepton1", "lepton1_phi", "lepton1_phi;1st leading lepton #phi;Events", 100, -pi, pi);
+      h_lepton1_q[i] = booker.book(subdir, "lepton1", "lepton1_q", "lepton1_q;1st leading lepton charge;Events", 3, -1.5, 1.5);
 
-      h_jets_n[i] = subdir.make<TH1D>("jets_n", "jets_n;Jet multiplicity;Events", 10, 0, 10);
-      h_jets_pt[i]  = subdir.make<TH1D>("jets_pt", "jets_pt;Jets p_{T} (GeV);Events/1GeV", 1000, 0, 1000);
-      h_jets_eta[i] = subdir.make<TH1D>("jets_eta", "jets_eta;Jets #eta;Events", 100, -maxeta, maxeta);
-      h_jets_ht[i] = subdir.make<TH1D>("jets_ht", "jets_ht;Jets #Sigma p_{T} (GeV);Events/1GeV", 1000, 0, 1000);
+      h_jets_n[i] = booker.book(subdir, "jets", "jets_n", "jets_n;Jet multiplicity;Events", 10, 0, 10);
+      h_jets_pt[i] = booker.book(subdir, "jets", "jets_pt", "jets_pt;Jets p_{T} (GeV);Events/1GeV", 1000, 0, 1000);
+      h_jets_eta[i] = booker.book(subdir, "jets", "jets_eta", "jets_eta;Jets #eta;Events", 100, -maxeta, maxeta);
+      h_jets_ht[i] = booker.book(subdir, "jets", "jets_ht", "jets_ht;Jets #Sigma p_{T} (GeV);Events/1GeV", 1000, 0, 1000);
 
       for ( int j=0; j<6; ++j ) {
         const string prefix = Form("jet%d_", j+1);
@@ -136,22 +137,22 @@ struct ControlPlotsTTLJ
         else if ( j == 1 ) titlePrefix = "2nd";
         else if ( j == 2 ) titlePrefix = "3rd";
         else titlePrefix = Form("%dth", j+1);
-        h_jet_m  [i][j] = subdir.make<TH1D>((prefix+"m").c_str(), (prefix+"m;"+titlePrefix+" leading jet mass (GeV);Events/1GeV").c_str(), 500, 0, 500);
-        h_jet_pt [i][j] = subdir.make<TH1D>((prefix+"pt").c_str(), (prefix+"pt;"+titlePrefix+" leading jet p_{T} (GeV);Events/1GeV").c_str(), 1000, 0, 1000);
-        h_jet_eta[i][j] = subdir.make<TH1D>((prefix+"eta").c_str(), (prefix+"eta;"+titlePrefix+" leading jet #eta;Events").c_str(), 100, -maxeta, maxeta);
-        h_jet_phi[i][j] = subdir.make<TH1D>((prefix+"phi").c_str(), (prefix+"phi;"+titlePrefix+" leading jet #phi;Events").c_str(), 100, -pi, pi);
-        h_jet_btag[i][j] = subdir.make<TH1D>((prefix+"btag").c_str(), (prefix+"btag;"+titlePrefix+" leading jet b discriminator output;Events").c_str(), 100, 0, 1);
+        h_jet_m  [i][j] = booker.book(subdir, "jet", (prefix+"m"), (prefix+"m;"+titlePrefix+" leading jet mass (GeV);Events/1GeV"), 500, 0, 500);
+        h_jet_pt [i][j] = booker.book(subdir, "jet", (prefix+"pt"), (prefix+"pt;"+titlePrefix+" leading jet p_{T} (GeV);Events/1GeV"), 1000, 0, 1000);
+        h_jet_eta[i][j] = booker.book(subdir, "jet", (prefix+"eta"), (prefix+"eta;"+titlePrefix+" leading jet #eta;Events"), 100, -maxeta, maxeta);
+        h_jet_phi[i][j] = booker.book(subdir, "jet", (prefix+"phi"), (prefix+"phi;"+titlePrefix+" leading jet #phi;Events"), 100, -pi, pi);
+        h_jet_btag[i][j] = booker.book(subdir, "jet", (prefix+"btag"), (prefix+"btag;"+titlePrefix+" leading jet b discriminator output;Events"), 100, 0, 1);
       }
 
-      h_bjets_n[i] = subdir.make<TH1D>("bjets_n", "bjets_n;b-jet multiplicity;Events", 10, 0, 10);
-      h_event_st[i] = subdir.make<TH1D>("event_st", "event_st;#Sigma p_{T} (GeV);Events/1GeV", 1000, 0, 1000);
+      h_bjets_n[i] = booker.book(subdir, "bjets", "bjets_n", "bjets_n;b-jet multiplicity;Events", 10, 0, 10);
+      h_event_st[i] = booker.book(subdir, "event", "event_st", "event_st;#Sigma p_{T} (GeV);Events/1GeV", 1000, 0, 1000);
 
       if ( i < 6 ) continue; // Book remaining histograms after the S4 Conv. veto (i=6)
 
-      h_event_mT[i] = subdir.make<TH1D>("event_mT", "event_mT;Transverse mass (GeV);Events/1GeV", 500, 0, 500);
-      h_event_mlj[i] = subdir.make<TH1D>("event_mlj", "event_mlj;Lepton+jet mass (GeV);Events/1GeV", 500, 0, 500);
-      h_event_mjj[i] = subdir.make<TH1D>("event_mjj", "event_mjj;Dijet mass (GeV);Events/1GeV", 500, 0, 500);
-      h_event_m3[i] = subdir.make<TH1D>("event_m3", "event_m3;M3 (GeV);Events/1GeV", 500, 0, 500);
+      h_event_mT[i] = booker.book(subdir, "event", "event_mT", "event_mT;Transverse mass (GeV);Events/1GeV", 500, 0, 500);
+      h_event_mlj[i] = booker.book(subdir, "event", "event_mlj", "event_mlj;Lepton+jet mass (GeV);Events/1GeV", 500, 0, 500);
+      h_event_mjj[i] = booker.book(subdir, "event", "event_mjj", "event_mjj;Dijet mass (GeV);Events/1GeV", 500, 0, 500);
+      h_event_m3[i] = booker.book(subdir, "event", "event_m3", "event_m3;M3 (GeV);Events/1GeV", 500, 0, 500);
     }
 
     isBooked = true;
@@ -165,6 +166,7 @@ class TTLJEventSelector : public edm::one::EDFilter<edm::one::SharedResources>
 public:
   TTLJEventSelector(const edm::ParameterSet& pset);
   bool filter(edm::Event& event, const edm::EventSetup&) override;
+  void endJob() override;
   ~TTLJEventSelector();
 
 private:
@@ -231,7 +233,7 @@ private:
 
     if ( isMVAElectronSel_ and !el.isTrigMVAValid() ) return false;
 
-    if ( !el.electronID(elIdName_) ) return false;
+    if ( !el.electronID(elIdIndex_) ) return false;
     //if ( !el.isPF() or !el.passConversionVeto() ) return false;
     const double scEta = std::abs(el.scEta());
     if ( isEcalCrackVeto_ and scEta > 1.4442 and scEta < 1.566 ) return false;
@@ -250,13 +252,13 @@ private:
   {
     if ( std::abs(el.eta()) > 2.4 ) return false;
     if ( std::isnan(el.pt()) or el.pt() < 10 ) return false;
-    if ( !el.electronID(elVetoIdName_) ) return false;
+    if ( !el.electronID(elVetoIdIndex_) ) return false;
     return true;
   }
   bool isBjet(const cat::Jet& jet)
   {
     using namespace cat;
-    const double bTag = jet.bDiscriminator(bTagName_);
+    const double bTag = jet.bDiscriminator(bTagIndex_);
     if      ( bTagWP_ == BTagWP::CSVL ) return bTag > WP_BTAG_CSVv2L;
     else if ( bTagWP_ == BTagWP::CSVM ) return bTag > WP_BTAG_CSVv2M;
     else if ( bTagWP_ == BTagWP::CSVT ) return bTag > WP_BTAG_CSVv2T;
@@ -282,13 +284,16 @@ private:
   bool isEcalCrackVeto_, isMVAElectronSel_;
   bool isSkipEleSmearing_;
   std::string bTagName_;
+  int bTagIndex_; // Position of bTagName_ in the jet discriminator list, resolved per event
   std::string elIdName_, elVetoIdName_;
+  int elIdIndex_, elVetoIdIndex_; // Positions in the electron ID list, resolved per event
   bool isIgnoreMuonIso_, isIgnoreElectronIso_;
   enum class BTagWP { CSVL, CSVM, CSVT } bTagWP_;
 
 private:
   TH1D* h_weight, * h_pileupWeight, * h_genWeight;
   ControlPlotsTTLJ h_el, h_mu;
+  ControlPlotBooker booker_;
 
 };
 
@@ -319,6 +324,7 @@ TTLJEventSelector::TTLJEventSelector(const edm::ParameterSet& pset):
   electronToken_ = consumes<cat::ElectronCollection>(electronSet.getParameter<edm::InputTag>("src"));
   elIdName_ = electronSet.getParameter<string>("idName");
   elVetoIdName_ = electronSet.getParameter<string>("vetoIdName");
+  elIdIndex_ = elVetoIdIndex_ = -1;
   electronScale_ = electronSet.getParameter<int>("scaleDirection");
   if ( isMC_ ) {
     const auto electronSFSet = electronSet.getParameter<edm::ParameterSet>("efficiencySF");
@@ -381,6 +387,9 @@ TTLJEventSelector::TTLJEventSelector(const edm::ParameterSet& pset):
   }
 
   // Fill histograms, etc
+  if ( pset.existsAs<std::vector<std::string> >("disabledHistogramGroups") ) {
+    booker_.setDisabledGroups(pset.getParameter<std::vector<std::string> >("disabledHistogramGroups"));
+  }
   if ( !skipHistograms_ ) {
     usesResource("TFileService");
     edm::Service<TFileService> fs;
@@ -392,8 +401,8 @@ TTLJEventSelector::TTLJEventSelector(const edm::ParameterSet& pset):
       h_pileupWeight = doverall.make<TH1D>("pileupWeight", "pileupWeight", 200, -10, 10);
     }
 
-    h_el.book(fs->mkdir("el"));
-    h_mu.book(fs->mkdir("mu"));
+    h_el.book(fs->mkdir("el"), booker_);
+    h_mu.book(fs->mkdir("mu"), booker_);
   }
 
   produces<int>("cutstep");
@@ -498,6 +507,10 @@ bool TTLJEventSelector::filter(edm::Event& event, const edm::EventSetup&)
     metDpy += lep.py()-p.py();
   }
   cat::ElectronCollection selElectrons, vetoElectrons;
+  if ( !electronHandle->empty() ) {
+    elIdIndex_ = electronHandle->at(0).checkedElectronIDIndex(elIdName_);
+    elVetoIdIndex_ = electronHandle->at(0).checkedElectronIDIndex(elVetoIdName_);
+  }
   for ( int i=0, n=electronHandle->size(); i<n; ++i ) {
     auto& p = electronHandle->at(i);
     const double scale = shiftedElectronScale(p)/(isSkipEleSmearing_ ? p.smearedScale() : 1);
@@ -555,6 +568,7 @@ bool TTLJEventSelector::filter(edm::Event& event, const edm::EventSetup&)
   // Select good jets
   int bjets_n = 0;
   double jets_ht = 0;
+  bTagIndex_ = jetHandle->empty() ? -1 : jetHandle->at(0).bDiscriminatorIndex(bTagName_);
   for ( int i=0, n=jetHandle->size(); i<n; ++i ) {
     auto& p = jetHandle->at(i);
     if ( std::abs(p.eta()) > 2.4 ) continue;
@@ -589,11 +603,11 @@ bool TTLJEventSelector::filter(edm::Event& event, const edm::EventSetup&)
 
     h_el.hCutstep->Fill(-2, weight);
     h_el.hCutstepNoweight->Fill(-2);
-    h_el.h_vertex_n[0]->Fill(nVertex, weight);
+    h_el.h_vertex_n[0].Fill(nVertex, weight);
 
     h_mu.hCutstep->Fill(-2, weight);
     h_mu.hCutstepNoweight->Fill(-2);
-    h_mu.h_vertex_n[0]->Fill(nVertex, weight);
+    h_mu.h_vertex_n[0].Fill(nVertex, weight);
   }
 
   // El channel Cutstep 0b with trigger requirements
@@ -603,23 +617,23 @@ bool TTLJEventSelector::filter(edm::Event& event, const edm::EventSetup&)
     if ( !skipHistograms_ ) {
       h_el.hCutstep->Fill(-1, weight);
       h_el.hCutstepNoweight->Fill(-1);
-      h_el.h_vertex_n[1]->Fill(nVertex, weight);
-      h_el.h_met_pt[1]->Fill(met_pt, weight);
-      h_el.h_met_phi[1]->Fill(met_phi, weight);
-      h_el.h_leptons_n[1]->Fill(leptons_n, weight);
+      h_el.h_vertex_n[1].Fill(nVertex, weight);
+      h_el.h_met_pt[1].Fill(met_pt, weight);
+      h_el.h_met_phi[1].Fill(met_phi, weight);
+      h_el.h_leptons_n[1].Fill(leptons_n, weight);
       if ( leptons_n >= 1 ) {
         const auto lepton1P4 = shiftedElectronScale(*lepton1)*lepton1->p4();
-        h_el.h_lepton1_pt[1]->Fill(lepton1P4.pt(), weight);
-        h_el.h_lepton1_eta[1]->Fill(lepton1->eta(), weight);
-        h_el.h_lepton1_phi[1]->Fill(lepton1->phi(), weight);
-        h_el.h_lepton1_q[1]->Fill(lepton1->charge(), weight);
+        h_el.h_lepton1_pt[1].Fill(lepton1P4.pt(), weight);
+        h_el.h_lepton1_eta[1].Fill(lepton1->eta(), weight);
+        h_el.h_lepton1_phi[1].Fill(lepton1->phi(), weight);
+        h_el.h_lepton1_q[1].Fill(lepton1->charge(), weight);
       }
-      h_el.h_jets_n[1]->Fill(jets_n, weight);
-      h_el.h_bjets_n[1]->Fill(bjets_n, weight);
-      h_el.h_jets_ht[1]->Fill(jets_ht, weight);
+      h_el.h_jets_n[1].Fill(jets_n, weight);
+      h_el.h_bjets_n[1].Fill(bjets_n, weight);
+      h_el.h_jets_ht[1].Fill(jets_ht, weight);
       for ( auto jet : *out_jets ) {
-        h_el.h_jets_pt[1]->Fill(jet.pt(), weight);
-        h_el.h_jets_eta[1]->Fill(jet.eta(), weight);
+        h_el.h_jets_pt[1].Fill(jet.pt(), weight);
+        h_el.h_jets_eta[1].Fill(jet.eta(), weight);
       }
     }
 
@@ -629,23 +643,23 @@ bool TTLJEventSelector::filter(edm::Event& event, const edm::EventSetup&)
       if ( !skipHistograms_ ) {
         h_el.hCutstep->Fill(0., weight);
         h_el.hCutstepNoweight->Fill(0.);
-        h_el.h_vertex_n[2]->Fill(nVertex, weight);
-        h_el.h_met_pt[2]->Fill(met_pt, weight);
-        h_el.h_met_phi[2]->Fill(met_phi, weight);
-        h_el.h_leptons_n[2]->Fill(leptons_n, weight);
+        h_el.h_vertex_n[2].Fill(nVertex, weight);
+        h_el.h_met_pt[2].Fill(met_pt, weight);
+        h_el.h_met_phi[2].Fill(met_phi, weight);
+        h_el.h_leptons_n[2].Fill(leptons_n, weight);
         if ( leptons_n >= 1 ) {
           const auto lepton1P4 = shiftedElectronScale(*lepton1)*lepton1->p4();
-          h_el.h_lepton1_pt[2]->Fill(lepton1P4.pt(), weight);
-          h_el.h_lepton1_eta[2]->Fill(lepton1->eta(), weight);
-          h_el.h_lepton1_phi[2]->Fill(lepton1->phi(), weight);
-          h_el.h_lepton1_q[2]->Fill(lepton1->charge(), weight);
+          h_el.h_lepton1_pt[2].Fill(lepton1P4.pt(), weight);
+          h_el.h_lepton1_eta[2].Fill(lepton1->eta(), weight);
+          h_el.h_lepton1_phi[2].Fill(lepton1->phi(), weight);
+          h_el.h_lepton1_q[2].Fill(lepton1->charge(), weight);
         }
-        h_el.h_jets_n[2]->Fill(jets_n, weight);
-        h_el.h_bjets_n[2]->Fill(bjets_n, weight);
-        h_el.h_jets_ht[2]->Fill(jets_ht, weight);
+        h_el.h_jets_n[2].Fill(jets_n, weight);
+        h_el.h_bjets_n[2].Fill(bjets_n, weight);
+        h_el.h_jets_ht[2].Fill(jets_ht, weight);
         for ( auto jet : *out_jets ) {
-          h_el.h_jets_pt[2]->Fill(jet.pt(), weight);
-          h_el.h_jets_eta[2]->Fill(jet.eta(), weight);
+          h_el.h_jets_pt[2].Fill(jet.pt(), weight);
+          h_el.h_jets_eta[2].Fill(jet.eta(), weight);
         }
       }
     }
@@ -657,23 +671,23 @@ bool TTLJEventSelector::filter(edm::Event& event, const edm::EventSetup&)
     if ( !skipHistograms_ ) {
       h_mu.hCutstep->Fill(-1, weight);
       h_mu.hCutstepNoweight->Fill(-1);
-      h_mu.h_vertex_n[1]->Fill(nVertex, weight);
-      h_mu.h_met_pt[1]->Fill(met_pt, weight);
-      h_mu.h_met_phi[1]->Fill(met_phi, weight);
-      h_mu.h_leptons_n[1]->Fill(leptons_n, weight);
+      h_mu.h_vertex_n[1].Fill(nVertex, weight);
+      h_mu.h_met_pt[1].Fill(met_pt, weight);
+      h_mu.h_met_phi[1].Fill(met_phi, weight);
+      h_mu.h_leptons_n[1].Fill(leptons_n, weight);
       if ( leptons_n >= 1 ) {
         const auto lepton1P4 = shiftedMuonScale(*lepton1)*lepton1->p4();
-        h_mu.h_lepton1_pt[1]->Fill(lepton1P4.pt(), weight);
-        h_mu.h_lepton1_eta[1]->Fill(lepton1->eta(), weight);
-        h_mu.h_lepton1_phi[1]->Fill(lepton1->phi(), weight);
-        h_mu.h_lepton1_q[1]->Fill(lepton1->charge(), weight);
+        h_mu.h_lepton1_pt[1].Fill(lepton1P4.pt(), weight);
+        h_mu.h_lepton1_eta[1].Fill(lepton1->eta(), weight);
+        h_mu.h_lepton1_phi[1].Fill(lepton1->phi(), weight);
+        h_mu.h_lepton1_q[1].Fill(lepton1->charge(), weight);
       }
-      h_mu.h_jets_n[1]->Fill(jets_n, weight);
-      h_mu.h_bjets_n[1]->Fill(bjets_n, weight);
-      h_mu.h_jets_ht[1]->Fill(jets_ht, weight);
+      h_mu.h_jets_n[1].Fill(jets_n, weight);
+      h_mu.h_bjets_n[1].Fill(bjets_n, weight);
+      h_mu.h_jets_ht[1].Fill(jets_ht, weight);
       for ( auto jet : *out_jets ) {
-        h_mu.h_jets_pt[1]->Fill(jet.pt(), weight);
-        h_mu.h_jets_eta[1]->Fill(jet.eta(), weight);
+        h_mu.h_jets_pt[1].Fill(jet.pt(), weight);
+        h_mu.h_jets_eta[1].Fill(jet.eta(), weight);
       }
     }
 
@@ -683,23 +697,23 @@ bool TTLJEventSelector::filter(edm::Event& event, const edm::EventSetup&)
       if ( !skipHistograms_ ) {
         h_mu.hCutstep->Fill(0., weight);
         h_mu.hCutstepNoweight->Fill(0.);
-        h_mu.h_vertex_n[2]->Fill(nVertex, weight);
-        h_mu.h_met_pt[2]->Fill(met_pt, weight);
-        h_mu.h_met_phi[2]->Fill(met_phi, weight);
-        h_mu.h_leptons_n[2]->Fill(leptons_n, weight);
+        h_mu.h_vertex_n[2].Fill(nVertex, weight);
+        h_mu.h_met_pt[2].Fill(met_pt, weight);
+        h_mu.h_met_phi[2].Fill(met_phi, weight);
+        h_mu.h_leptons_n[2].Fill(leptons_n, weight);
         if ( leptons_n >= 1 ) {
           const auto lepton1P4 = shiftedMuonScale(*lepton1)*lepton1->p4();
-          h_mu.h_lepton1_pt[2]->Fill(lepton1P4.pt(), weight);
-          h_mu.h_lepton1_eta[2]->Fill(lepton1->eta(), weight);
-          h_mu.h_lepton1_phi[2]->Fill(lepton1->phi(), weight);
-          h_mu.h_lepton1_q[2]->Fill(lepton1->charge(), weight);
+          h_mu.h_lepton1_pt[2].Fill(lepton1P4.pt(), weight);
+          h_mu.h_lepton1_eta[2].Fill(lepton1->eta(), weight);
+          h_mu.h_lepton1_phi[2].Fill(lepton1->phi(), weight);
+          h_mu.h_lepton1_q[2].Fill(lepton1->charge(), weight);
         }
-        h_mu.h_jets_n[2]->Fill(jets_n, weight);
-        h_mu.h_bjets_n[2]->Fill(bjets_n, weight);
-        h_mu.h_jets_ht[2]->Fill(jets_ht, weight);
+        h_mu.h_jets_n[2].Fill(jets_n, weight);
+        h_mu.h_bjets_n[2].Fill(bjets_n, weight);
+        h_mu.h_jets_ht[2].Fill(jets_ht, weight);
         for ( auto jet : *out_jets ) {
-          h_mu.h_jets_pt[2]->Fill(jet.pt(), weight);
-          h_mu.h_jets_eta[2]->Fill(jet.eta(), weight);
+          h_mu.h_jets_pt[2].Fill(jet.pt(), weight);
+          h_mu.h_jets_eta[2].Fill(jet.eta(), weight);
         }
       }
     }
@@ -760,30 +774,30 @@ bool TTLJEventSelector::filter(edm::Event& event, const edm::EventSetup&)
         h.hCutstep->Fill(icutstep, weight);
         h.hCutstepNoweight->Fill(icutstep);
 
-        h.h_vertex_n[i]->Fill(nVertex, weight);
-        h.h_met_pt[i]->Fill(met_pt, weight);
-        h.h_met_phi[i]->Fill(met_phi, weight);
-        h.h_leptons_n[i]->Fill(leptons_n, weight);
-        h.h_lepton1_pt[i]->Fill(lepton1P4.pt(), weight);
-        h.h_lepton1_eta[i]->Fill(lepton1->eta(), weight);
-        h.h_lepton1_phi[i]->Fill(lepton1->phi(), weight);
-        h.h_lepton1_q[i]->Fill(lepton1->charge(), weight);
-        h.h_jets_n[i]->Fill(jets_n, weight);
-        h.h_jets_ht[i]->Fill(jets_ht, weight);
+        h.h_vertex_n[i].Fill(nVertex, weight);
+        h.h_met_pt[i].Fill(met_pt, weight);
+        h.h_met_phi[i].Fill(met_phi, weight);
+        h.h_leptons_n[i].Fill(leptons_n, weight);
+        h.h_lepton1_pt[i].Fill(lepton1P4.pt(), weight);
+        h.h_lepton1_eta[i].Fill(lepton1->eta(), weight);
+        h.h_lepton1_phi[i].Fill(lepton1->phi(), weight);
+        h.h_lepton1_q[i].Fill(lepton1->charge(), weight);
+        h.h_jets_n[i].Fill(jets_n, weight);
+        h.h_jets_ht[i].Fill(jets_ht, weight);
         for ( auto jet : *out_jets ) {
-          h.h_jets_pt[i]->Fill(jet.pt(), weight);
-          h.h_jets_eta[i]->Fill(jet.eta(), weight);
+          h.h_jets_pt[i].Fill(jet.pt(), weight);
+          h.h_jets_eta[i].Fill(jet.eta(), weight);
         }
         for ( int j=0, n=std::min(6, jets_n); j<n; ++j ) {
           const auto& jet = out_jets->at(j);
-          h.h_jet_m[i][j]->Fill(jet.mass(), weight);
-          h.h_jet_pt[i][j]->Fill(jet.pt(), weight);
-          h.h_jet_eta[i][j]->Fill(jet.eta(), weight);
-          h.h_jet_phi[i][j]->Fill(jet.phi(), weight);
-          h.h_jet_btag[i][j]->Fill(jet.bDiscriminator(bTagName_), weight);
+          h.h_jet_m[i][j].Fill(jet.mass(), weight);
+          h.h_jet_pt[i][j].Fill(jet.pt(), weight);
+          h.h_jet_eta[i][j].Fill(jet.eta(), weight);
+          h.h_jet_phi[i][j].Fill(jet.phi(), weight);
+          h.h_jet_btag[i][j].Fill(jet.bDiscriminator(bTagIndex_), weight);
         }
-        h.h_bjets_n[i]->Fill(bjets_n, weight);
-        h.h_event_st[i]->Fill(leptons_st+jets_ht+met_pt, weight);
+        h.h_bjets_n[i].Fill(bjets_n, weight);
+        h.h_event_st[i].Fill(leptons_st+jets_ht+met_pt, weight);
 
         if ( i < 6 ) continue; // Fill remaining histograms after the S4 Conv. veto (i=6)
 
@@ -812,10 +826,10 @@ bool TTLJEventSelector::filter(edm::Event& event, const edm::EventSetup&)
             }
           }
         }
-        h.h_event_mT[i]->Fill(mT, weight);
-        h.h_event_mlj[i]->Fill(mlj, weight);
-        h.h_event_mjj[i]->Fill(mjj, weight);
-        h.h_event_m3[i]->Fill(m3, weight);
+        h.h_event_mT[i].Fill(mT, weight);
+        h.h_event_mlj[i].Fill(mlj, weight);
+        h.h_event_mjj[i].Fill(mjj, weight);
+        h.h_event_m3[i].Fill(m3, weight);
       }
     }
 
@@ -855,6 +869,11 @@ bool TTLJEventSelector::filter(edm::Event& event, const edm::EventSetup&)
   return false;
 }
 
+void TTLJEventSelector::endJob()
+{
+  booker_.write();
+}
+
 TTLJEventSelector::~TTLJEventSelector()
 {
   if ( h_el.isBooked ) {
@@ -10,6 +10,7 @@
 
 #include "CATTools/CommonTools/interface/TTbarModeDefs.h"
 #include "CATTools/CommonTools/interface/ScaleFactorEvaluator.h"
+#include "CATTools/CommonTools/interface/ControlPlotBooker.h"
 #include "CATTools/CatAnalyzer/interface/TopTriggerSF.h"
 
 #include "DataFormats/Candidate/interface/LeafCandidate.h"
@@ -34,12 +35,12 @@ struct ControlPlotsTTLL
     "step0a", "step0b", "step0c", "step1", "step2", "step3", "step4", "step5"
   };
 
-  typedef TH1D* H1;
+  typedef cat::ControlPlotBooker::H1 H1;
   typedef TH2D* H2;
 
   bool isBooked;
 
-  H1 hCutstep, hCutstepNoweight;
+  TH1D* hCutstep, * hCutstepNoweight;
   H2 h2Cutstep, h2CutstepNoweight;
 
   H1 h_vertex_n[nCutstep];
@@ -54,7 +55,7 @@ struct ControlPlotsTTLL
   H1 h_bjets_n[nCutstep];
   H1 h_event_st[nCutstep];
 
-  void book(TFileDirectory&& dir)
+  void book(TFileDirectory&& dir, ControlPlotBooker& booker)
   {
     const double maxeta = 3;
     const double pi = 3.141592;
@@ -83,48 +84,48 @@ struct ControlPlotsTTLL
     }
 
     auto subdir = dir.mkdir(stepNames[0]);
-    h_vertex_n[0] = subdir.make<TH1D>("vertex_n", "vertex_n;Number of primary vertices;Events", 100, 0, 100);
+    h_vertex_n[0] = booker.book(subdir, "vertex", "vertex_n", "vertex_n;Number of primary vertices;Events", 100, 0, 100);
 
     for ( int i=1; i<=2; ++i ) {
       subdir = dir.mkdir(stepNames[i]);
-      h_vertex_n[i] = subdir.make<TH1D>("vertex_n", "vertex_n;Number of primary vertices;Events", 100, 0, 100);
-      h_met_pt[i] = subdir.make<TH1D>("met_pt", "met_pt;Missing transverse momentum (GeV);Events/1GeV", 1000, 0, 1000);
-      h_met_phi[i] = subdir.make<TH1D>("met_phi", "met_phi;Missing transverse momentum #phi;Events", 100, -pi, pi);
-      h_leptons_n[i] = subdir.make<TH1D>("leptons_n", "leptons_n;Lepton multiplicity;Events", 10, 0, 10);
-      h_jets_n[i] = subdir.make<TH1D>("jets_n", "jets_n;Jet multiplicity;Events", 10, 0, 10);
-      h_jets_pt[i]  = subdir.make<TH1D>("jets_pt", "jets_pt;Jets p_{T} (GeV);Events/1GeV", 1000, 0, 1000);
-      h_jets_eta[i] = subdir.make<TH1D>("jets_eta", "jets_eta;Jets #eta;Events", 100, -maxeta, maxeta);
-      h_jets_ht[i] = subdir.make<TH1D>("jets_ht", "jets_ht;Jets #Sigma p_{T} (GeV);Events/1GeV", 1000, 0, 1000);
-      h_bjets_n[i] = subdir.make<TH1D>("bjets_n", "bjets_n;b-jet multiplicity;Events", 10, 0, 10);
+      h_vertex_n[i] = booker.book(subdir, "vertex", "vertex_n", "vertex_n;Number of primary vertices;Events", 100, 0, 100);
+      h_met_pt[i] = booker.book(subdir, "met", "met_pt", "met_pt;Missing transverse momentum (GeV);Events/1GeV", 1000, 0, 1000);
+      h_met_phi[i] = booker.book(subdir, "met", "met_phi", "met_phi;Missing transverse momentum #phi;Events", 100, -pi, pi);
+      h_leptons_n[i] = booker.book(subdir, "leptons", "leptons_n", "leptons_n;Lepton multiplicity;Events", 10, 0, 10);
+      h_jets_n[i] = booker.book(subdir, "jets", "jets_n", "jets_n;Jet multiplicity;Events", 10, 0, 10);
+      h_jets_pt[i] = booker.book(subdir, "jets", "jets_pt", "jets_pt;Jets p_{T} (GeV);Events/1GeV", 1000, 0, 1000);
+      h_jets_eta[i] = booker.book(subdir, "jets", "jets_eta", "jets_eta;Jets #eta;Events", 100, -maxeta, maxeta);
+      h_jets_ht[i] = booker.book(subdir, "jets", "jets_ht", "jets_ht;Jets #Sigma p_{T} (GeV);Events/1GeV", 1000, 0, 1000);
+      h_bjets_n[i] = booker.book(subdir, "bjets", "bjets_n", "bjets_n;b-jet multiplicity;Events", 10, 0, 10);
     }
 
     for ( int i=3; i<nCutstep; ++i ) {
       subdir = dir.mkdir(stepNames[i]);
-      h_vertex_n[i] = subdir.make<TH1D>("vertex_n", "vertex_n;Number of primary vertices;Events", 100, 0, 100);
-      h_met_pt[i] = subdir.make<TH1D>("met_pt", "met_pt;Missing transverse momentum (GeV);Events/1GeV", 1000, 0, 1000);
-      h_met_phi[i] = subdir.make<TH1D>("met_phi", "met_phi;Missing transverse momentum #phi;Events", 100, -pi, pi);
-      h_leptons_n[i] = subdir.make<TH1D>("leptons_n", "leptons_n;Lepton multiplicity;Events", 10, 0, 10);
-
-      h_lepton1_pt [i] = subdir.make<TH1D>("lepton1_pt", "lepton1_pt;1st leading lepton p_{T} (GeV);Events/1GeV", 1000, 0, 1000);
-      h_lepton1_eta[i] = subdir.make<TH1D>("lepton1_eta", "lepton1_eta;1st leading lepton #eta;Events", 100, -maxeta, maxeta);
-      h_lepton1_phi[i] = subdir.make<TH1D>("lepton1_phi", "lepton1_phi;1st leading lepton #phi;Events", 100, -pi, pi);
-      h_lepton1_q  [i] = subdir.make<TH1D>("lepton1_q", "lepton1_q;1st leading lepton charge;Events", 3, -1.5, 1.5);
-
-      h_lepton2_pt [i] = subdir.make<TH1D>("lepton2_pt", "lepton2_pt", 1000, 0, 1000);
-      h_lepton2_eta[i] = subdir.make<TH1D>("lepton2_eta", "lepton2_eta", 100, -maxeta, maxeta);
-      h_lepton2_phi[i] = subdir.make<TH1D>("lepton2_phi", "lepton2_phi", 100, -pi, pi);
-      h_lepton2_q  [i] = subdir.make<TH1D>("lepton2_q", "lepton2_q;2nd leading lepton charge;Events", 3, -1.5, 1.5);
-
-      h_z_m  [i] = subdir.make<TH1D>("z_m", "z_m", 1000, 0, 1000);
-      h_z_pt [i] = subdir.make<TH1D>("z_pt", "z_pt", 1000, 0, 1000);
-      h_z_eta[i] = subdir.make<TH1D>("z_eta", "z_eta", 100, -maxeta, maxeta);
-      h_z_phi[i] = subdir.make<TH1D>("z_phi", "z_phi", 100, -pi, pi);
-      h_z_m_noveto[i] = subdir.make<TH1D>("z_m_noveto", "z_m_noveto", 1000, 0, 1000);
-
-      h_jets_n[i] = subdir.make<TH1D>("jets_n", "jets_n;Jet multiplicity;Events", 10, 0, 10);
-      h_jets_pt [i] = subdir.make<TH1D>("jets_pt", "jets_pt;Jets p_{T} (GeV);Events/1GeV", 1000, 0, 1000);
-      h_jets_eta[i] = subdir.make<TH1D>("jets_eta", "jets_eta;Jets #eta;Events", 100, -maxeta, maxeta);
-      h_jets_ht[i] = subdir.make<TH1D>("jets_ht", "jets_ht;Jets #Sigma p_{T} (GeV);Events/1GeV", 1000, 0, 1000);
+      h_vertex_n[i] = booker.book(subdir, "vertex", "vertex_n", "vertex_n;Number of primary vertices;Events", 100, 0, 100);
+      h_met_pt[i] = booker.book(subdir, "met", "met_pt", "met_pt;Missing transverse momentum (GeV);Events/1GeV", 1000, 0, 1000);
+      h_met_phi[i] = booker.book(subdir, "met", "met_phi", "met_phi;Missing transverse momentum #phi;Events", 100, -pi, pi);
+      h_leptons_n[i] = booker.book(subdir, "leptons", "leptons_n", "leptons_n;Lepton multiplicity;Events", 10, 0, 10);
+
+      h_lepton1_pt [i] = booker.book(subdir, "lepton1", "lepton1_pt", "lepton1_pt;1st leading lepton p_{T} (GeV);Events/1GeV", 1000, 0, 1000);
+      h_lepton1_eta[i] = booker.book(subdir, "lepton1", "lepton1_eta", "lepton1_eta;1st leading lepton #eta;Events", 100, -maxeta, maxeta);
+      h_lepton1_phi[i] = booker.book(subdir, "lepton1", "lepton1_phi", "lepton1_phi;1st leading lepton #phi;Events", 100, -pi, pi);
+      h_lepton1_q  [i] = booker.book(subdir, "lepton1", "lepton1_q", "lepton1_q;1st leading lepton charge;Events", 3, -1.5, 1.5);
+
+      h_lepton2_pt [i] = booker.book(subdir, "lepton2", "lepton2_pt", "lepton2_pt", 1000, 0, 1000);
+      h_lepton2_eta[i] = booker.book(subdir, "lepton2", "lepton2_eta", "lepton2_eta", 100, -maxeta, maxeta);
+      h_lepton2_phi[i] = booker.book(subdir, "lepton2", "lepton2_phi", "lepton2_phi", 100, -pi, pi);
+      h_lepton2_q  [i] = booker.book(subdir, "lepton2", "lepton2_q", "lepton2_q;2nd leading lepton charge;Events", 3, -1.5, 1.5);
+
+      h_z_m  [i] = booker.book(subdir, "z", "z_m", "z_m", 1000, 0, 1000);
+      h_z_pt [i] = booker.book(subdir, "z", "z_pt", "z_pt", 1000, 0, 1000);
+      h_z_eta[i] = booker.book(subdir, "z", "z_eta", "z_eta", 100, -maxeta, maxeta);
+      h_z_phi[i] = booker.book(subdir, "z", "z_phi", "z_phi", 100, -pi, pi);
+      h_z_m_noveto[i] = booker.book(subdir, "z", "z_m_noveto", "z_m_noveto", 1000, 0, 1000);
+
+      h_jets_n[i] = booker.book(subdir, "jets", "jets_n", "jets_n;Jet multiplicity;Events", 10, 0, 10);
+      h_jets_pt [i] = booker.book(subdir, "jets", "jets_pt", "jets_pt;Jets p_{T} (GeV);Events/1GeV", 1000, 0, 1000);
+      h_jets_eta[i] = booker.book(subdir, "jets", "jets_eta", "jets_eta;Jets #eta;Events", 100, -maxeta, maxeta);
+      h_jets_ht[i] = booker.book(subdir, "jets", "jets_ht", "jets_ht;Jets #Sigma p_{T} (GeV);Events/1GeV", 1000, 0, 1000);
 
       for ( int j=0; j<4; ++j ) {
         const string prefix = Form("jet%d_", j+1);
@@ -133,15 +134,15 @@ struct ControlPlotsTTLL
         else if ( j == 1 ) titlePrefix = "2nd";
         else if ( j == 2 ) titlePrefix = "3rd";
         else titlePrefix = Form("%dth", j+1);
-        h_jet_m  [i][j] = subdir.make<TH1D>((prefix+"m").c_str(), (prefix+"m;"+titlePrefix+" leading jet mass (GeV);Events/1GeV").c_str(), 500, 0, 500);
-        h_jet_pt [i][j] = subdir.make<TH1D>((prefix+"pt").c_str(), (prefix+"pt;"+titlePrefix+" leading jet p_{T} (GeV);Events/1GeV").c_str(), 1000, 0, 1000);
-        h_jet_eta[i][j] = subdir.make<TH1D>((prefix+"eta").c_str(), (prefix+"eta;"+titlePrefix+" leading jet #eta;Events").c_str(), 100, -maxeta, maxeta);
-        h_jet_phi[i][j] = subdir.make<TH1D>((prefix+"phi").c_str(), (prefix+"phi;"+titlePrefix+" leading jet #phi;Events").c_str(), 100, -pi, pi);
-        h_jet_btag[i][j] = subdir.make<TH1D>((prefix+"btag").c_str(), (prefix+"btag;"+titlePrefix+" leading jet b discriminator output;Events").c_str(), 100, 0, 1);
+        h_jet_m  [i][j] = booker.book(subdir, "jet", (prefix+"m"), (prefix+"m;"+titlePrefix+" leading jet mass (GeV);Events/1GeV"), 500, 0, 500);
+        h_jet_pt [i][j] = booker.book(subdir, "jet", (prefix+"pt"), (prefix+"pt;"+titlePrefix+" leading jet p_{T} (GeV);Events/1GeV"), 1000, 0, 1000);
+        h_jet_eta[i][j] = booker.book(subdir, "jet", (prefix+"eta"), (prefix+"eta;"+titlePrefix+" leading jet #eta;Events"), 100, -maxeta, maxeta);
+        h_jet_phi[i][j] = booker.book(subdir, "jet", (prefix+"phi"), (prefix+"phi;"+titlePrefix+" leading jet #phi;Events"), 100, -pi, pi);
+        h_jet_btag[i][j] = booker.book(subdir, "jet", (prefix+"btag"), (prefix+"btag;"+titlePrefix+" leading jet b discriminator output;Events"), 100, 0, 1);
       }
 
-      h_bjets_n[i] = subdir.make<TH1D>("bjets_n", "bjets_n;b-jet multiplicity;Events", 10, 0, 10);
-      h_event_st[i] = subdir.make<TH1D>("event_st", "event_st;#Sigma p_{T} (GeV);Events/1GeV", 1000, 0, 1000);
+      h_bjets_n[i] = booker.book(subdir, "bjets", "bjets_n", "bjets_n;b-jet multiplicity;Events", 10, 0, 10);
+      h_event_st[i] = booker.book(subdir, "event", "event_st", "event_st;#Sigma p_{T} (GeV);Events/1GeV", 1000, 0, 1000);
     }
 
     isBooked = true;
@@ -155,6 +156,7 @@ class TTLLEventSelector : public edm::one::EDFilter<edm::one::SharedResources>
 public:
   TTLLEventSelector(const edm::ParameterSet& pset);
   bool filter(edm::Event& event, const edm::EventSetup&) override;
+  void endJob() override;
   ~TTLLEventSelector();
 
 private:
@@ -177,32 +179,46 @@ private:
   std::vector<edm::EDGetTokenT<double> > extWeightTokensD_;
 
 private:
-  double shiftedMuonScale(const cat::Muon& mu) {
-    if      ( muonScale_ > 0 ) return mu.shiftedEnUp();
-    else if ( muonScale_ < 0 ) return mu.shiftedEnDown();
+  // Energy scale choice of one variation. The first entry of variations_ is the nominal one
+  // configured by the scaleDirection parameters, the others come from the "variations" VPSet
+  // and produce the same set of products with the label appended to the instance names.
+  struct Variation
+  {
+    std::string label;
+    int muonScale, electronScale, jetScale, jetResol;
+
+    TH1D* h_weight = nullptr;
+    ControlPlotsTTLL h_ee, h_mm, h_em;
+  };
+  std::vector<Variation> variations_;
+  ControlPlotBooker booker_;
+
+  double shiftedMuonScale(const cat::Muon& mu, const Variation& var) {
+    if      ( var.muonScale > 0 ) return mu.shiftedEnUp();
+    else if ( var.muonScale < 0 ) return mu.shiftedEnDown();
     return 1;
   }
-  double shiftedElectronScale(const cat::Electron& el) {
-    if      ( electronScale_ > 0 ) return el.shiftedEnUp();
-    else if ( electronScale_ < 0 ) return el.shiftedEnDown();
+  double shiftedElectronScale(const cat::Electron& el, const Variation& var) {
+    if      ( var.electronScale > 0 ) return el.shiftedEnUp();
+    else if ( var.electronScale < 0 ) return el.shiftedEnDown();
     return 1;
   }
-  double shiftedLepScale(const reco::Candidate& cand)
+  double shiftedLepScale(const reco::Candidate& cand, const Variation& var)
   {
     auto muonP = dynamic_cast<const cat::Muon*>(&cand);
     auto electronP = dynamic_cast<const cat::Electron*>(&cand);
-    if ( muonP ) return shiftedMuonScale(*muonP);
-    else if ( electronP ) return shiftedElectronScale(*electronP);
+    if ( muonP ) return shiftedMuonScale(*muonP, var);
+    else if ( electronP ) return shiftedElectronScale(*electronP, var);
     return cand.pt();
   }
-  double shiftedJetScale(const reco::Candidate& cand)
+  double shiftedJetScale(const reco::Candidate& cand, const Variation& var)
   {
-    const auto jet = dynamic_cast<const cat::Jet&>(cand);
+    const auto& jet = dynamic_cast<const cat::Jet&>(cand);
     double scale = 1.;
-    if      ( jetScale_ == +1 ) scale *= jet.shiftedEnUp();
-    else if ( jetScale_ == -1 ) scale *= jet.shiftedEnDown();
+    if      ( var.jetScale == +1 ) scale *= jet.shiftedEnUp();
+    else if ( var.jetScale == -1 ) scale *= jet.shiftedEnDown();
 
-    if ( isMC_ and !isSkipJER_ ) scale *= jet.smearedRes(jetResol_);
+    if ( isMC_ and !isSkipJER_ ) scale *= jet.smearedRes(var.jetResol);
 
     return scale;
   }
@@ -222,7 +238,7 @@ private:
 
     if ( isMVAElectronSel_ and !el.isTrigMVAValid() ) return false;
 
-    if ( !el.electronID(elIdName_) ) return false;
+    if ( !el.electronID(elIdIndex_) ) return false;
     //if ( !el.isPF() or !el.passConversionVeto() ) return false;
     const double scEta = std::abs(el.scEta());
     if ( isEcalCrackVeto_ and scEta > 1.4442 and scEta < 1.566 ) return false;
@@ -231,7 +247,7 @@ private:
   bool isBjet(const cat::Jet& jet)
   {
     using namespace cat;
-    const double bTag = jet.bDiscriminator(bTagName_);
+    const double bTag = jet.bDiscriminator(bTagIndex_);
     if      ( bTagWP_ == BTagWP::CSVL ) return bTag > WP_BTAG_CSVv2L;
     else if ( bTagWP_ == BTagWP::CSVM ) return bTag > WP_BTAG_CSVv2M;
     else if ( bTagWP_ == BTagWP::CSVT ) return bTag > WP_BTAG_CSVv2T;
@@ -239,8 +255,6 @@ private:
   }
 
 private:
-  // Energy scales
-  int muonScale_, electronScale_, jetScale_, jetResol_;
   bool isSkipJER_; // Do not apply JER, needed to remove randomness during the Synchronization
 
   // Efficiency SF
@@ -258,12 +272,13 @@ private:
   bool isSkipEleSmearing_;
   bool isIgnoreMuonIso_, isIgnoreElectronIso_;
   std::string bTagName_;
+  int bTagIndex_; // Position of bTagName_ in the jet discriminator list, resolved per event
   std::string elIdName_;
+  int elIdIndex_; // Position of elIdName_ in the electron ID list, resolved per event
   enum class BTagWP { CSVL, CSVM, CSVT } bTagWP_;
 
 private:
-  TH1D* h_weight, * h_pileupWeight, * h_genWeight;
-  ControlPlotsTTLL h_ee, h_mm, h_em;
+  TH1D* h_pileupWeight, * h_genWeight;
 
 };
 
@@ -278,7 +293,8 @@ TTLLEventSelector::TTLLEventSelector(const edm::ParameterSet& pset):
 {
   const auto muonSet = pset.getParameter<edm::ParameterSet>("muon");
   muonToken_ = consumes<cat::MuonCollection>(muonSet.getParameter<edm::InputTag>("src"));
-  muonScale_ = muonSet.getParameter<int>("scaleDirection");
+  Variation nominal;
+  nominal.muonScale = muonSet.getParameter<int>("scaleDirection");
   if ( isMC_ ) {
     const auto muonSFSet = muonSet.getParameter<edm::ParameterSet>("efficiencySF");
     // FIXME : for muons, eta bins are folded - always double check this with cfg
@@ -293,7 +309,8 @@ TTLLEventSelector::TTLLEventSelector(const edm::ParameterSet& pset):
   const auto electronSet = pset.getParameter<edm::ParameterSet>("electron");
   electronToken_ = consumes<cat::ElectronCollection>(electronSet.getParameter<edm::InputTag>("src"));
   elIdName_ = electronSet.getParameter<string>("idName");
-  electronScale_ = electronSet.getParameter<int>("scaleDirection");
+  elIdIndex_ = -1;
+  nominal.electronScale = electronSet.getParameter<int>("scaleDirection");
   if ( isMC_ ) {
     const auto electronSFSet = electronSet.getParameter<edm::ParameterSet>("efficiencySF");
     // FIXME : for electrons, eta bins are NOT folded - always double check this with cfg
@@ -315,8 +332,8 @@ TTLLEventSelector::TTLLEventSelector(const edm::ParameterSet& pset):
 
   const auto jetSet = pset.getParameter<edm::ParameterSet>("jet");
   jetToken_ = consumes<cat::JetCollection>(jetSet.getParameter<edm::InputTag>("src"));
-  jetScale_ = jetSet.getParameter<int>("scaleDirection");
-  jetResol_ = jetSet.getParameter<int>("resolDirection");
+  nominal.jetScale = jetSet.getParameter<int>("scaleDirection");
+  nominal.jetResol = jetSet.getParameter<int>("resolDirection");
   bTagName_ = jetSet.getParameter<string>("bTagName");
   const auto bTagWPStr = jetSet.getParameter<string>("bTagWP");
   if      ( bTagWPStr == "CSVL" ) bTagWP_ = BTagWP::CSVL;
@@ -348,6 +365,25 @@ TTLLEventSelector::TTLLEventSelector(const edm::ParameterSet& pset):
     else genWeightsToken_ = consumes<vfloat>(genWeightSet.getParameter<edm::InputTag>("src"));
   }
 
+  // Additional energy scale variations, evaluated from the same input collections.
+  // Directions not given in a variation are taken from the nominal configuration.
+  variations_.push_back(nominal);
+  if ( pset.existsAs<std::vector<edm::ParameterSet> >("variations") ) {
+    for ( const auto& varSet : pset.getParameter<std::vector<edm::ParameterSet> >("variations") ) {
+      Variation var = nominal;
+      var.label = varSet.getParameter<string>("label");
+      if ( var.label.empty() ) throw cms::Exception("TTLLEventSelector") << "Empty label in the variations";
+      for ( const auto& x : variations_ ) {
+        if ( x.label == var.label ) throw cms::Exception("TTLLEventSelector") << "Duplicated variation label " << var.label;
+      }
+      if ( varSet.existsAs<int>("muonScale") ) var.muonScale = varSet.getParameter<int>("muonScale");
+      if ( varSet.existsAs<int>("electronScale") ) var.electronScale = varSet.getParameter<int>("electronScale");
+      if ( varSet.existsAs<int>("jetScale") ) var.jetScale = varSet.getParameter<int>("jetScale");
+      if ( varSet.existsAs<int>("jetResol") ) var.jetResol = varSet.getParameter<int>("jetResol");
+      variations_.push_back(var);
+    }
+  }
+
   // Other weights
   const auto extWeightLabels = pset.getParameter<std::vector<edm::InputTag> >("extWeights");
   for ( auto x : extWeightLabels ) {
@@ -359,27 +395,39 @@ TTLLEventSelector::TTLLEventSelector(const edm::ParameterSet& pset):
   usesResource("TFileService");
   edm::Service<TFileService> fs;
 
+  if ( pset.existsAs<std::vector<std::string> >("disabledHistogramGroups") ) {
+    booker_.setDisabledGroups(pset.getParameter<std::vector<std::string> >("disabledHistogramGroups"));
+  }
   if ( !skipHistograms_ ) {
     auto doverall = fs->mkdir("overall", "overall");
-    h_weight = doverall.make<TH1D>("weight", "weight", 200, -10, 10);
     if ( isMC_ ) {
       h_genWeight = doverall.make<TH1D>("genWeight", "genWeight", 200, -10, 10);
       h_pileupWeight = doverall.make<TH1D>("pileupWeight", "pileupWeight", 200, -10, 10);
     }
 
-    h_ee.book(fs->mkdir("ee"));
-    h_mm.book(fs->mkdir("mm"));
-    h_em.book(fs->mkdir("em"));
+    // Nominal histograms at the top directory, variations in their own subdirectories
+    // with the same layout as the nominal one.
+    for ( auto& var : variations_ ) {
+      TFileDirectory dir = var.label.empty() ? static_cast<TFileDirectory&>(*fs) : fs->mkdir(var.label);
+      auto dvaroverall = var.label.empty() ? doverall : dir.mkdir("overall");
+      var.h_weight = dvaroverall.make<TH1D>("weight", "weight", 200, -10, 10);
+
+      var.h_ee.book(dir.mkdir("ee"), booker_);
+      var.h_mm.book(dir.mkdir("mm"), booker_);
+      var.h_em.book(dir.mkdir("em"), booker_);
+    }
   }
 
-  produces<int>("cutstep");
-  produces<int>("channel");
-  produces<float>("weight");
-  produces<float>("met");
-  produces<float>("metphi");
-  produces<std::vector<cat::Muon> >("muons");
-  produces<std::vector<cat::Electron> >("electrons");
-  produces<std::vector<cat::Jet> >("jets");
+  for ( const auto& var : variations_ ) {
+    produces<int>("cutstep"+var.label);
+    produces<int>("channel"+var.label);
+    produces<float>("weight"+var.label);
+    produces<float>("met"+var.label);
+    produces<float>("metphi"+var.label);
+    produces<std::vector<cat::Muon> >("muons"+var.label);
+    produces<std::vector<cat::Electron> >("electrons"+var.label);
+    produces<std::vector<cat::Jet> >("jets"+var.label);
+  }
 }
 
 bool TTLLEventSelector::filter(edm::Event& event, const edm::EventSetup&)
@@ -399,18 +447,13 @@ bool TTLLEventSelector::filter(edm::Event& event, const edm::EventSetup&)
   edm::Handle<cat::METCollection> metHandle;
   event.getByToken(metToken_, metHandle);
   const auto& metP4 = metHandle->at(0).p4();
-  double metDpx = 0, metDpy = 0;
 
   edm::Handle<int> nVertexHandle;
   event.getByToken(nVertexToken_, nVertexHandle);
   const int nVertex = *nVertexHandle;
 
-  std::auto_ptr<std::vector<cat::Electron> > out_electrons(new std::vector<cat::Electron>());
-  std::auto_ptr<std::vector<cat::Muon> > out_muons(new std::vector<cat::Muon>());
-  std::auto_ptr<std::vector<cat::Jet> > out_jets(new std::vector<cat::Jet>());
-
   // Compute event weight - from generator, pileup, etc
-  double weight = 1.0;
+  double eventWeight = 1.0;
   if ( isMC_ ) {
     float genWeight = 1.;
     edm::Handle<float> fHandle;
@@ -432,18 +475,18 @@ bool TTLLEventSelector::filter(edm::Event& event, const edm::EventSetup&)
       h_genWeight->Fill(genWeight);
       h_pileupWeight->Fill(pileupWeight);
     }
-    weight *= genWeight*pileupWeight;
+    eventWeight *= genWeight*pileupWeight;
     // NOTE: weight value to be multiplied by lepton SF, etc.
   }
 
   // Apply all other weights
   for ( auto t : extWeightTokensF_ ) {
     edm::Handle<float> h;
-    if ( event.getByToken(t, h) ) weight *= *h;
+    if ( event.getByToken(t, h) ) eventWeight *= *h;
   }
   for ( auto t : extWeightTokensD_ ) {
     edm::Handle<double> h;
-    if ( event.getByToken(t, h) ) weight *= *h;
+    if ( event.getByToken(t, h) ) eventWeight *= *h;
   }
 
   // Get event filters and triggers
@@ -458,396 +501,437 @@ bool TTLLEventSelector::filter(edm::Event& event, const edm::EventSetup&)
   event.getByToken(trigMuElToken_, trigHandle);
   const int isTrigMuEl = *trigHandle;
 
-  // Select good leptons
-  double leptons_st = 0;
-  cat::MuonCollection selMuons;
+  // Object quality cuts are evaluated with the input momenta, thus they are common to all variations.
+  // Keep indices of the objects passing them and apply the energy scales per variation.
+  std::vector<int> muonIdxs, electronIdxs, jetIdxs;
   for ( int i=0, n=muonHandle->size(); i<n; ++i ) {
     auto& p = muonHandle->at(i);
-    const double scale = shiftedMuonScale(p);
-
-    cat::Muon lep(p);
-    lep.setP4(p.p4()*scale);
     if ( !isGoodMuon(p) ) continue;
     if ( !isIgnoreMuonIso_ && p.relIso(0.4) > 0.15 ) continue;
 
-    selMuons.push_back(lep);
-
-    leptons_st += lep.pt();
-    metDpx += lep.px()-p.px();
-    metDpy += lep.py()-p.py();
+    muonIdxs.push_back(i);
   }
-  cat::ElectronCollection selElectrons;
+  elIdIndex_ = electronHandle->empty() ? -1 : electronHandle->at(0).checkedElectronIDIndex(elIdName_);
   for ( int i=0, n=electronHandle->size(); i<n; ++i ) {
     auto& p = electronHandle->at(i);
-    const double scale = shiftedElectronScale(p)/(isSkipEleSmearing_ ? p.smearedScale() : 1);
-
-    cat::Electron lep(p);
-    lep.setP4(p.p4()*scale);
     if ( !isGoodElectron(p) ) continue;
     if ( !isIgnoreElectronIso_ && p.relIso(0.3) >= 0.11 ) continue;
 
-    selElectrons.push_back(lep);
-
-    leptons_st += lep.pt();
-    metDpx += lep.px()-p.px()/(isSkipEleSmearing_ ? p.smearedScale() : 1);
-    metDpy += lep.py()-p.py()/(isSkipEleSmearing_ ? p.smearedScale() : 1);
-  }
-  std::vector<const cat::Lepton*> selLeptons;
-  for ( auto& x : selMuons ) selLeptons.push_back(&x);
-  for ( auto& x : selElectrons ) selLeptons.push_back(&x);
-  std::sort(selLeptons.begin(), selLeptons.end(),
-            [&](const cat::Lepton* a, const cat::Lepton* b){return a->pt() > b->pt();});
-  // Copy selLeptons to out_leptons
-  for ( int i=0, n=std::min(2,int(selLeptons.size())); i<n; ++i ) {
-    const cat::Electron* el = dynamic_cast<const cat::Electron*>(selLeptons.at(i));
-    const cat::Muon* mu = dynamic_cast<const cat::Muon*>(selLeptons.at(i));
-    if ( el ) out_electrons->push_back(*el);
-    else if ( mu ) out_muons->push_back(*mu);
+    electronIdxs.push_back(i);
   }
-  const int leptons_n = selLeptons.size();
-  const cat::Lepton* lepton1 = leptons_n > 0 ? selLeptons.at(0) : 0;
-  const cat::Lepton* lepton2 = leptons_n > 1 ? selLeptons.at(1) : 0;
-  int channel = CH_NOLL;
-  if ( leptons_n >= 2 ) {
-    const int pdgId1 = std::abs(lepton1->pdgId());
-    const int pdgId2 = std::abs(lepton2->pdgId());
-    // Determine channel
-    switch ( pdgId1+pdgId2 ) {
-      case 11+11: { channel = CH_ELEL; break; }
-      case 13+13: { channel = CH_MUMU; break; }
-      case 11+13: {
-        channel = CH_MUEL;
-        // Put electron front for emu channel
-        if ( pdgId1 == 13 and pdgId2 == 11 ) std::swap(lepton1, lepton2);
-      }
-    }
-    // Apply lepton SF
-    if ( channel != CH_NOLL ) weight *= computeTrigSF(*lepton1, *lepton2, trigSFShift_);
-
-    if ( channel == CH_ELEL ) {
-      const auto e1 = dynamic_cast<const cat::Electron*>(lepton1);
-      const auto e2 = dynamic_cast<const cat::Electron*>(lepton2);
-      const double w1 = electronSF_(lepton1->pt(), e1->scEta(), electronSFShift_);
-      const double w2 = electronSF_(lepton2->pt(), e2->scEta(), electronSFShift_);
-      weight *= w1*w2;
-      if ( !isIgnoreTrig_ ) weight *= isTrigElEl;
-    }
-    else if ( channel == CH_MUMU ) {
-      const double w1 = muonSF_(lepton1->pt(), lepton1->eta(), muonSFShift_);
-      const double w2 = muonSF_(lepton2->pt(), lepton2->eta(), muonSFShift_);
-      weight *= w1*w2;
-      if ( !isIgnoreTrig_ ) weight *= isTrigMuMu;
-    }
-    else if ( channel == CH_MUEL ) {
-      const auto e1 = dynamic_cast<const cat::Electron*>(lepton1);
-      const double w1 = electronSF_(lepton1->pt(), e1->scEta(), electronSFShift_);
-      const double w2 = muonSF_(lepton2->pt(), lepton2->eta(), muonSFShift_);
-      weight *= w1*w2;
-      if ( !isIgnoreTrig_ ) weight *= isTrigMuEl;
-    }
-    else edm::LogError("TTLLEventSelector") << "Strange event with nLepton >=2 but not falling info ee,mumu,emu category";
-  }
-  const double z_m = leptons_n < 2 ? -1 : (lepton1->p4()+lepton2->p4()).mass();
-
-  // Select good jets
-  int bjets_n = 0;
-  double jets_ht = 0;
+  bTagIndex_ = jetHandle->empty() ? -1 : jetHandle->at(0).bDiscriminatorIndex(bTagName_);
   for ( int i=0, n=jetHandle->size(); i<n; ++i ) {
     auto& p = jetHandle->at(i);
     if ( std::abs(p.eta()) > 2.4 ) continue;
     if ( !p.LooseId() ) continue;
 
-    const double scale = shiftedJetScale(p);
-    cat::Jet jet(p);
-    jet.setP4(scale*p.p4());
+    jetIdxs.push_back(i);
+  }
 
-    metDpx += jet.px()-p.px();
-    metDpy += jet.py()-p.py();
-    if ( jet.pt() < 30 ) continue;
+  bool isAccepted = false;
+  for ( auto& var : variations_ ) {
+    auto& h_ee = var.h_ee, & h_mm = var.h_mm, & h_em = var.h_em;
 
-    if ( leptons_n >= 1 and deltaR(jet.p4(), lepton1->p4()) < 0.4 ) continue;
-    if ( leptons_n >= 2 and deltaR(jet.p4(), lepton2->p4()) < 0.4 ) continue;
+    std::auto_ptr<std::vector<cat::Electron> > out_electrons(new std::vector<cat::Electron>());
+    std::auto_ptr<std::vector<cat::Muon> > out_muons(new std::vector<cat::Muon>());
+    std::auto_ptr<std::vector<cat::Jet> > out_jets(new std::vector<cat::Jet>());
+    double weight = eventWeight;
+    double metDpx = 0, metDpy = 0;
 
-    jets_ht += jet.pt();
-    if ( isBjet(p) ) ++bjets_n;
+    // Select good leptons
+    double leptons_st = 0;
+    cat::MuonCollection selMuons;
+    for ( const int i : muonIdxs ) {
+      auto& p = muonHandle->at(i);
+      const double scale = shiftedMuonScale(p, var);
 
-    out_jets->push_back(jet);
-  }
-  const int jets_n = out_jets->size();
-  std::sort(out_jets->begin(), out_jets->end(),
-            [&](const cat::Jet& a, const cat::Jet& b){return a.pt() > b.pt();});
+      cat::Muon lep(p);
+      lep.setP4(p.p4()*scale);
 
-  // Update & calculate met
-  const double met_pt = hypot(metP4.px()-metDpx, metP4.py()-metDpy);
-  const double met_phi = atan2(metP4.px()-metDpx, metP4.py()-metDpy);
+      selMuons.push_back(lep);
 
-  // Check cut steps and fill histograms
-  if ( !skipHistograms_ ) {
-    h_weight->Fill(weight);
+      leptons_st += lep.pt();
+      metDpx += lep.px()-p.px();
+      metDpy += lep.py()-p.py();
+    }
+    cat::ElectronCollection selElectrons;
+    for ( const int i : electronIdxs ) {
+      auto& p = electronHandle->at(i);
+      const double scale = shiftedElectronScale(p, var)/(isSkipEleSmearing_ ? p.smearedScale() : 1);
 
-    h_ee.hCutstep->Fill(-2, weight);
-    h_ee.hCutstepNoweight->Fill(-2);
-    h_ee.h_vertex_n[0]->Fill(nVertex, weight);
+      cat::Electron lep(p);
+      lep.setP4(p.p4()*scale);
 
-    h_mm.hCutstep->Fill(-2, weight);
-    h_mm.hCutstepNoweight->Fill(-2);
-    h_mm.h_vertex_n[0]->Fill(nVertex, weight);
+      selElectrons.push_back(lep);
 
-    h_em.hCutstep->Fill(-2, weight);
-    h_em.hCutstepNoweight->Fill(-2);
-    h_em.h_vertex_n[0]->Fill(nVertex, weight);
-  }
+      leptons_st += lep.pt();
+      metDpx += lep.px()-p.px()/(isSkipEleSmearing_ ? p.smearedScale() : 1);
+      metDpy += lep.py()-p.py()/(isSkipEleSmearing_ ? p.smearedScale() : 1);
+    }
+    std::vector<const cat::Lepton*> selLeptons;
+    for ( auto& x : selMuons ) selLeptons.push_back(&x);
+    for ( auto& x : selElectrons ) selLeptons.push_back(&x);
+    std::sort(selLeptons.begin(), selLeptons.end(),
+              [&](const cat::Lepton* a, const cat::Lepton* b){return a->pt() > b->pt();});
+    // Copy selLeptons to out_leptons
+    for ( int i=0, n=std::min(2,int(selLeptons.size())); i<n; ++i ) {
+      const cat::Electron* el = dynamic_cast<const cat::Electron*>(selLeptons.at(i));
+      const cat::Muon* mu = dynamic_cast<const cat::Muon*>(selLeptons.at(i));
+      if ( el ) out_electrons->push_back(*el);
+      else if ( mu ) out_muons->push_back(*mu);
+    }
+    const int leptons_n = selLeptons.size();
+    const cat::Lepton* lepton1 = leptons_n > 0 ? selLeptons.at(0) : 0;
+    const cat::Lepton* lepton2 = leptons_n > 1 ? selLeptons.at(1) : 0;
+    int channel = CH_NOLL;
+    if ( leptons_n >= 2 ) {
+      const int pdgId1 = std::abs(lepton1->pdgId());
+      const int pdgId2 = std::abs(lepton2->pdgId());
+      // Determine channel
+      switch ( pdgId1+pdgId2 ) {
+        case 11+11: { channel = CH_ELEL; break; }
+        case 13+13: { channel = CH_MUMU; break; }
+        case 11+13: {
+          channel = CH_MUEL;
+          // Put electron front for emu channel
+          if ( pdgId1 == 13 and pdgId2 == 11 ) std::swap(lepton1, lepton2);
+        }
+      }
+      // Apply lepton SF
+      if ( channel != CH_NOLL ) weight *= computeTrigSF(*lepton1, *lepton2, trigSFShift_);
+
+      if ( channel == CH_ELEL ) {
+        const auto e1 = dynamic_cast<const cat::Electron*>(lepton1);
+        const auto e2 = dynamic_cast<const cat::Electron*>(lepton2);
+        const double w1 = electronSF_(lepton1->pt(), e1->scEta(), electronSFShift_);
+        const double w2 = electronSF_(lepton2->pt(), e2->scEta(), electronSFShift_);
+        weight *= w1*w2;
+        if ( !isIgnoreTrig_ ) weight *= isTrigElEl;
+      }
+      else if ( channel == CH_MUMU ) {
+        const double w1 = muonSF_(lepton1->pt(), lepton1->eta(), muonSFShift_);
+        const double w2 = muonSF_(lepton2->pt(), lepton2->eta(), muonSFShift_);
+        weight *= w1*w2;
+        if ( !isIgnoreTrig_ ) weight *= isTrigMuMu;
+      }
+      else if ( channel == CH_MUEL ) {
+        const auto e1 = dynamic_cast<const cat::Electron*>(lepton1);
+        const double w1 = electronSF_(lepton1->pt(), e1->scEta(), electronSFShift_);
+        const double w2 = muonSF_(lepton2->pt(), lepton2->eta(), muonSFShift_);
+        weight *= w1*w2;
+        if ( !isIgnoreTrig_ ) weight *= isTrigMuEl;
+      }
+      else edm::LogError("TTLLEventSelector") << "Strange event with nLepton >=2 but not falling info ee,mumu,emu category";
+    }
+    const double z_m = leptons_n < 2 ? -1 : (lepton1->p4()+lepton2->p4()).mass();
+
+    // Select good jets
+    int bjets_n = 0;
+    double jets_ht = 0;
+    for ( const int i : jetIdxs ) {
+      auto& p = jetHandle->at(i);
+
+      const double scale = shiftedJetScale(p, var);
+      cat::Jet jet(p);
+      jet.setP4(scale*p.p4());
+
+      metDpx += jet.px()-p.px();
+      metDpy += jet.py()-p.py();
+      if ( jet.pt() < 30 ) continue;
 
-  // ElEl channel Cutstep 0b with trigger requirements
-  int cutstep_ee = -2;
-  if ( isIgnoreTrig_ or isTrigElEl ) {
-    ++cutstep_ee;
+      if ( leptons_n >= 1 and deltaR(jet.p4(), lepton1->p4()) < 0.4 ) continue;
+      if ( leptons_n >= 2 and deltaR(jet.p4(), lepton2->p4()) < 0.4 ) continue;
+
+      jets_ht += jet.pt();
+      if ( isBjet(p) ) ++bjets_n;
+
+      out_jets->push_back(jet);
+    }
+    const int jets_n = out_jets->size();
+    std::sort(out_jets->begin(), out_jets->end(),
+              [&](const cat::Jet& a, const cat::Jet& b){return a.pt() > b.pt();});
+
+    // Update & calculate met
+    const double met_pt = hypot(metP4.px()-metDpx, metP4.py()-metDpy);
+    const double met_phi = atan2(metP4.px()-metDpx, metP4.py()-metDpy);
+
+    // Check cut steps and fill histograms
     if ( !skipHistograms_ ) {
-      h_ee.hCutstep->Fill(-1, weight);
-      h_ee.hCutstepNoweight->Fill(-1);
-      h_ee.h_vertex_n[1]->Fill(nVertex, weight);
-      h_ee.h_met_pt[1]->Fill(met_pt, weight);
-      h_ee.h_met_phi[1]->Fill(met_phi, weight);
-      h_ee.h_leptons_n[1]->Fill(leptons_n, weight);
-      h_ee.h_jets_n[1]->Fill(jets_n, weight);
-      h_ee.h_bjets_n[1]->Fill(bjets_n, weight);
-      h_ee.h_jets_ht[1]->Fill(jets_ht, weight);
-      for ( auto jet : *out_jets ) {
-        h_ee.h_jets_pt[1]->Fill(jet.pt(), weight);
-        h_ee.h_jets_eta[1]->Fill(jet.eta(), weight);
-      }
+      var.h_weight->Fill(weight);
+
+      h_ee.hCutstep->Fill(-2, weight);
+      h_ee.hCutstepNoweight->Fill(-2);
+      h_ee.h_vertex_n[0].Fill(nVertex, weight);
+
+      h_mm.hCutstep->Fill(-2, weight);
+      h_mm.hCutstepNoweight->Fill(-2);
+      h_mm.h_vertex_n[0].Fill(nVertex, weight);
+
+      h_em.hCutstep->Fill(-2, weight);
+      h_em.hCutstepNoweight->Fill(-2);
+      h_em.h_vertex_n[0].Fill(nVertex, weight);
     }
 
-    // Cutstep 0c with reco filters
-    if ( isRECOFilterOK ) {
+    // ElEl channel Cutstep 0b with trigger requirements
+    int cutstep_ee = -2;
+    if ( isIgnoreTrig_ or isTrigElEl ) {
       ++cutstep_ee;
       if ( !skipHistograms_ ) {
-        h_ee.hCutstep->Fill(0., weight);
-        h_ee.hCutstepNoweight->Fill(0.);
-        h_ee.h_vertex_n[2]->Fill(nVertex, weight);
-        h_ee.h_met_pt[2]->Fill(met_pt, weight);
-        h_ee.h_met_phi[2]->Fill(met_phi, weight);
-        h_ee.h_leptons_n[2]->Fill(leptons_n, weight);
-        h_ee.h_jets_n[2]->Fill(jets_n, weight);
-        h_ee.h_bjets_n[2]->Fill(bjets_n, weight);
-        h_ee.h_jets_ht[2]->Fill(jets_ht, weight);
+        h_ee.hCutstep->Fill(-1, weight);
+        h_ee.hCutstepNoweight->Fill(-1);
+        h_ee.h_vertex_n[1].Fill(nVertex, weight);
+        h_ee.h_met_pt[1].Fill(met_pt, weight);
+        h_ee.h_met_phi[1].Fill(met_phi, weight);
+        h_ee.h_leptons_n[1].Fill(leptons_n, weight);
+        h_ee.h_jets_n[1].Fill(jets_n, weight);
+        h_ee.h_bjets_n[1].Fill(bjets_n, weight);
+        h_ee.h_jets_ht[1].Fill(jets_ht, weight);
         for ( auto jet : *out_jets ) {
-          h_ee.h_jets_pt[2]->Fill(jet.pt(), weight);
-          h_ee.h_jets_eta[2]->Fill(jet.eta(), weight);
+          h_ee.h_jets_pt[1].Fill(jet.pt(), weight);
+          h_ee.h_jets_eta[1].Fill(jet.eta(), weight);
         }
       }
-    }
-  }
 
-  // MuMu channel Cutstep 0b with trigger requirements
-  int cutstep_mm = -2;
-  if ( isIgnoreTrig_ or isTrigMuMu ) {
-    ++cutstep_mm;
-    if ( !skipHistograms_ ) {
-      h_mm.hCutstep->Fill(-1, weight);
-      h_mm.hCutstepNoweight->Fill(-1);
-      h_mm.h_vertex_n[1]->Fill(nVertex, weight);
-      h_mm.h_met_pt[1]->Fill(met_pt, weight);
-      h_mm.h_met_phi[1]->Fill(met_phi, weight);
-      h_mm.h_leptons_n[1]->Fill(leptons_n, weight);
-      h_mm.h_jets_n[1]->Fill(jets_n, weight);
-      h_mm.h_bjets_n[1]->Fill(bjets_n, weight);
-      h_mm.h_jets_ht[1]->Fill(jets_ht, weight);
-      for ( auto jet : *out_jets ) {
-        h_mm.h_jets_pt[1]->Fill(jet.pt(), weight);
-        h_mm.h_jets_eta[1]->Fill(jet.eta(), weight);
+      // Cutstep 0c with reco filters
+      if ( isRECOFilterOK ) {
+        ++cutstep_ee;
+        if ( !skipHistograms_ ) {
+          h_ee.hCutstep->Fill(0., weight);
+          h_ee.hCutstepNoweight->Fill(0.);
+          h_ee.h_vertex_n[2].Fill(nVertex, weight);
+          h_ee.h_met_pt[2].Fill(met_pt, weight);
+          h_ee.h_met_phi[2].Fill(met_phi, weight);
+          h_ee.h_leptons_n[2].Fill(leptons_n, weight);
+          h_ee.h_jets_n[2].Fill(jets_n, weight);
+          h_ee.h_bjets_n[2].Fill(bjets_n, weight);
+          h_ee.h_jets_ht[2].Fill(jets_ht, weight);
+          for ( auto jet : *out_jets ) {
+            h_ee.h_jets_pt[2].Fill(jet.pt(), weight);
+            h_ee.h_jets_eta[2].Fill(jet.eta(), weight);
+          }
+        }
       }
     }
 
-    // Cutstep 0c with reco filters
-    if ( isRECOFilterOK ) {
+    // MuMu channel Cutstep 0b with trigger requirements
+    int cutstep_mm = -2;
+    if ( isIgnoreTrig_ or isTrigMuMu ) {
       ++cutstep_mm;
       if ( !skipHistograms_ ) {
-        h_mm.hCutstep->Fill(0., weight);
-        h_mm.hCutstepNoweight->Fill(0.);
-        h_mm.h_vertex_n[2]->Fill(nVertex, weight);
-        h_mm.h_met_pt[2]->Fill(met_pt, weight);
-        h_mm.h_met_phi[2]->Fill(met_phi, weight);
-        h_mm.h_leptons_n[2]->Fill(leptons_n, weight);
-        h_mm.h_jets_n[2]->Fill(jets_n, weight);
-        h_mm.h_bjets_n[2]->Fill(bjets_n, weight);
-        h_mm.h_jets_ht[2]->Fill(jets_ht, weight);
+        h_mm.hCutstep->Fill(-1, weight);
+        h_mm.hCutstepNoweight->Fill(-1);
+        h_mm.h_vertex_n[1].Fill(nVertex, weight);
+        h_mm.h_met_pt[1].Fill(met_pt, weight);
+        h_mm.h_met_phi[1].Fill(met_phi, weight);
+        h_mm.h_leptons_n[1].Fill(leptons_n, weight);
+        h_mm.h_jets_n[1].Fill(jets_n, weight);
+        h_mm.h_bjets_n[1].Fill(bjets_n, weight);
+        h_mm.h_jets_ht[1].Fill(jets_ht, weight);
         for ( auto jet : *out_jets ) {
-          h_mm.h_jets_pt[2]->Fill(jet.pt(), weight);
-          h_mm.h_jets_eta[2]->Fill(jet.eta(), weight);
+          h_mm.h_jets_pt[1].Fill(jet.pt(), weight);
+          h_mm.h_jets_eta[1].Fill(jet.eta(), weight);
         }
       }
-    }
-  }
-  // MuEl channel Cutstep 0b with trigger requirements
-  int cutstep_em = -2;
-  if ( isIgnoreTrig_ or isTrigMuEl ) {
-    ++cutstep_em;
-    if ( !skipHistograms_ ) {
-      h_em.hCutstep->Fill(-1, weight);
-      h_em.hCutstepNoweight->Fill(-1);
-      h_em.h_vertex_n[1]->Fill(nVertex, weight);
-      h_em.h_met_pt[1]->Fill(met_pt, weight);
-      h_em.h_met_phi[1]->Fill(met_phi, weight);
-      h_em.h_leptons_n[1]->Fill(leptons_n, weight);
-      h_em.h_jets_n[1]->Fill(jets_n, weight);
-      h_em.h_bjets_n[1]->Fill(bjets_n, weight);
-      h_em.h_jets_ht[1]->Fill(jets_ht, weight);
-      for ( auto jet : *out_jets ) {
-        h_em.h_jets_pt[1]->Fill(jet.pt(), weight);
-        h_em.h_jets_eta[1]->Fill(jet.eta(), weight);
+
+      // Cutstep 0c with reco filters
+      if ( isRECOFilterOK ) {
+        ++cutstep_mm;
+        if ( !skipHistograms_ ) {
+          h_mm.hCutstep->Fill(0., weight);
+          h_mm.hCutstepNoweight->Fill(0.);
+          h_mm.h_vertex_n[2].Fill(nVertex, weight);
+          h_mm.h_met_pt[2].Fill(met_pt, weight);
+          h_mm.h_met_phi[2].Fill(met_phi, weight);
+          h_mm.h_leptons_n[2].Fill(leptons_n, weight);
+          h_mm.h_jets_n[2].Fill(jets_n, weight);
+          h_mm.h_bjets_n[2].Fill(bjets_n, weight);
+          h_mm.h_jets_ht[2].Fill(jets_ht, weight);
+          for ( auto jet : *out_jets ) {
+            h_mm.h_jets_pt[2].Fill(jet.pt(), weight);
+            h_mm.h_jets_eta[2].Fill(jet.eta(), weight);
+          }
+        }
       }
     }
-
-    // Cutstep 0c with reco filters
-    if ( isRECOFilterOK ) {
+    // MuEl channel Cutstep 0b with trigger requirements
+    int cutstep_em = -2;
+    if ( isIgnoreTrig_ or isTrigMuEl ) {
       ++cutstep_em;
       if ( !skipHistograms_ ) {
-        h_em.hCutstep->Fill(0., weight);
-        h_em.hCutstepNoweight->Fill(0.);
-        h_em.h_vertex_n[2]->Fill(nVertex, weight);
-        h_em.h_met_pt[2]->Fill(met_pt, weight);
-        h_em.h_met_phi[2]->Fill(met_phi, weight);
-        h_em.h_leptons_n[2]->Fill(leptons_n, weight);
-        h_em.h_jets_n[2]->Fill(jets_n, weight);
-        h_em.h_bjets_n[2]->Fill(bjets_n, weight);
-        h_em.h_jets_ht[2]->Fill(jets_ht, weight);
+        h_em.hCutstep->Fill(-1, weight);
+        h_em.hCutstepNoweight->Fill(-1);
+        h_em.h_vertex_n[1].Fill(nVertex, weight);
+        h_em.h_met_pt[1].Fill(met_pt, weight);
+        h_em.h_met_phi[1].Fill(met_phi, weight);
+        h_em.h_leptons_n[1].Fill(leptons_n, weight);
+        h_em.h_jets_n[1].Fill(jets_n, weight);
+        h_em.h_bjets_n[1].Fill(bjets_n, weight);
+        h_em.h_jets_ht[1].Fill(jets_ht, weight);
         for ( auto jet : *out_jets ) {
-          h_em.h_jets_pt[2]->Fill(jet.pt(), weight);
-          h_em.h_jets_eta[2]->Fill(jet.eta(), weight);
+          h_em.h_jets_pt[1].Fill(jet.pt(), weight);
+          h_em.h_jets_eta[1].Fill(jet.eta(), weight);
+        }
+      }
+
+      // Cutstep 0c with reco filters
+      if ( isRECOFilterOK ) {
+        ++cutstep_em;
+        if ( !skipHistograms_ ) {
+          h_em.hCutstep->Fill(0., weight);
+          h_em.hCutstepNoweight->Fill(0.);
+          h_em.h_vertex_n[2].Fill(nVertex, weight);
+          h_em.h_met_pt[2].Fill(met_pt, weight);
+          h_em.h_met_phi[2].Fill(met_phi, weight);
+          h_em.h_leptons_n[2].Fill(leptons_n, weight);
+          h_em.h_jets_n[2].Fill(jets_n, weight);
+          h_em.h_bjets_n[2].Fill(bjets_n, weight);
+          h_em.h_jets_ht[2].Fill(jets_ht, weight);
+          for ( auto jet : *out_jets ) {
+            h_em.h_jets_pt[2].Fill(jet.pt(), weight);
+            h_em.h_jets_eta[2].Fill(jet.eta(), weight);
+          }
         }
       }
     }
-  }
 
-  // Check each cut steps
-  int cutstep = -1;
-  // bitset for the cut steps, fill the results only for events that pass step0a,0b,0c
-  std::bitset<ControlPlotsTTLL::nCutstep-2> cutstepBits;
-  cutstepBits.reset();
-  if ( (channel == CH_ELEL and cutstep_ee == 0) or
-       (channel == CH_MUMU and cutstep_mm == 0) or
-       (channel == CH_MUEL and cutstep_em == 0) ) {
-    // Step1 Dilepton
-    if ( leptons_n >= 2 and z_m >= 20 and lepton1->charge()+lepton2->charge() == 0 ) {
-      cutstepBits[0] = true;
-      // Step2 Z mass veto : Step1 have to be required by construction
-      if ( channel == CH_MUEL or !(76 <= z_m and z_m <= 106) ) cutstepBits[1] = true;
+    // Check each cut steps
+    int cutstep = -1;
+    // bitset for the cut steps, fill the results only for events that pass step0a,0b,0c
+    std::bitset<ControlPlotsTTLL::nCutstep-2> cutstepBits;
+    cutstepBits.reset();
+    if ( (channel == CH_ELEL and cutstep_ee == 0) or
+         (channel == CH_MUMU and cutstep_mm == 0) or
+         (channel == CH_MUEL and cutstep_em == 0) ) {
+      // Step1 Dilepton
+      if ( leptons_n >= 2 and z_m >= 20 and lepton1->charge()+lepton2->charge() == 0 ) {
+        cutstepBits[0] = true;
+        // Step2 Z mass veto : Step1 have to be required by construction
+        if ( channel == CH_MUEL or !(76 <= z_m and z_m <= 106) ) cutstepBits[1] = true;
+      }
+      // Step3 Missing transverse momentum
+      if ( channel == CH_MUEL or met_pt >= 40 ) cutstepBits[2] = true;
+      // Step4 Minimal jet multiplicity
+      if ( jets_n >= 2 ) cutstepBits[3] = true;
+      // Step5 one b jet
+      if ( bjets_n >= 1 ) cutstepBits[4] = true;
+
+      // Set the cut step of this event
+      const int nstep = cutstepBits.size();
+      for ( cutstep=0; cutstep<nstep; ++cutstep ) {
+        if ( !cutstepBits[cutstep] ) break;
+      }
     }
-    // Step3 Missing transverse momentum
-    if ( channel == CH_MUEL or met_pt >= 40 ) cutstepBits[2] = true;
-    // Step4 Minimal jet multiplicity
-    if ( jets_n >= 2 ) cutstepBits[3] = true;
-    // Step5 one b jet
-    if ( bjets_n >= 1 ) cutstepBits[4] = true;
-
-    // Set the cut step of this event
-    const int nstep = cutstepBits.size();
-    for ( cutstep=0; cutstep<nstep; ++cutstep ) {
-      if ( !cutstepBits[cutstep] ) break;
+    else {
+      cutstep = std::max(cutstep_ee, std::max(cutstep_mm, cutstep_em)); // reset the cut step
     }
-  }
-  else {
-    cutstep = std::max(cutstep_ee, std::max(cutstep_mm, cutstep_em)); // reset the cut step
-  }
 
-  if ( !skipHistograms_ ) {
-    auto& h = channel == CH_ELEL ? h_ee : channel == CH_MUMU ? h_mm : h_em;
-
-    // Cut step is ready. Now proceed to fill histograms
-    if ( cutstep > 0 ) {
-      const auto lepton1P4 = shiftedLepScale(*lepton1)*lepton1->p4();
-      const auto lepton2P4 = shiftedLepScale(*lepton2)*lepton2->p4();
-
-      const auto zP4 = lepton1P4+lepton2P4;
-
-      for ( int i=3; i<ControlPlotsTTLL::nCutstep; ++i ) {
-        const int icutstep = i-2;
-        if ( cutstep < icutstep ) break;
-
-        h.hCutstep->Fill(icutstep, weight);
-        h.hCutstepNoweight->Fill(icutstep);
-
-        h.h_vertex_n[i]->Fill(nVertex, weight);
-        h.h_met_pt[i]->Fill(met_pt, weight);
-        h.h_met_phi[i]->Fill(met_phi, weight);
-        h.h_leptons_n[i]->Fill(leptons_n, weight);
-        h.h_lepton1_pt[i]->Fill(lepton1P4.pt(), weight);
-        h.h_lepton1_eta[i]->Fill(lepton1->eta(), weight);
-        h.h_lepton1_phi[i]->Fill(lepton1->phi(), weight);
-        h.h_lepton1_q[i]->Fill(lepton1->charge(), weight);
-        h.h_lepton2_pt[i]->Fill(lepton2P4.pt(), weight);
-        h.h_lepton2_eta[i]->Fill(lepton2->eta(), weight);
-        h.h_lepton2_phi[i]->Fill(lepton2->phi(), weight);
-        h.h_lepton2_q[i]->Fill(lepton2->charge(), weight);
-        h.h_z_m[i]->Fill(z_m, weight);
-        h.h_z_pt[i]->Fill(zP4.pt(), weight);
-        h.h_z_eta[i]->Fill(zP4.eta(), weight);
-        h.h_z_phi[i]->Fill(zP4.phi(), weight);
-        h.h_jets_n[i]->Fill(jets_n, weight);
-        h.h_jets_ht[i]->Fill(jets_ht, weight);
-        for ( auto jet : *out_jets ) {
-          h.h_jets_pt[i]->Fill(jet.pt(), weight);
-          h.h_jets_eta[i]->Fill(jet.eta(), weight);
-        }
-        for ( int j=0, n=std::min(jets_n, 4); j<n; ++j ) {
-          const auto& jet = out_jets->at(j);
-          h.h_jet_m[i][j]->Fill(jet.mass(), weight);
-          h.h_jet_pt[i][j]->Fill(jet.pt(), weight);
-          h.h_jet_eta[i][j]->Fill(jet.eta(), weight);
-          h.h_jet_phi[i][j]->Fill(jet.phi(), weight);
-          h.h_jet_btag[i][j]->Fill(jet.bDiscriminator(bTagName_), weight);
+    if ( !skipHistograms_ ) {
+      auto& h = channel == CH_ELEL ? h_ee : channel == CH_MUMU ? h_mm : h_em;
+
+      // Cut step is ready. Now proceed to fill histograms
+      if ( cutstep > 0 ) {
+        const auto lepton1P4 = shiftedLepScale(*lepton1, var)*lepton1->p4();
+        const auto lepton2P4 = shiftedLepScale(*lepton2, var)*lepton2->p4();
+
+        const auto zP4 = lepton1P4+lepton2P4;
+
+        for ( int i=3; i<ControlPlotsTTLL::nCutstep; ++i ) {
+          const int icutstep = i-2;
+          if ( cutstep < icutstep ) break;
+
+          h.hCutstep->Fill(icutstep, weight);
+          h.hCutstepNoweight->Fill(icutstep);
+
+          h.h_vertex_n[i].Fill(nVertex, weight);
+          h.h_met_pt[i].Fill(met_pt, weight);
+          h.h_met_phi[i].Fill(met_phi, weight);
+          h.h_leptons_n[i].Fill(leptons_n, weight);
+          h.h_lepton1_pt[i].Fill(lepton1P4.pt(), weight);
+          h.h_lepton1_eta[i].Fill(lepton1->eta(), weight);
+          h.h_lepton1_phi[i].Fill(lepton1->phi(), weight);
+          h.h_lepton1_q[i].Fill(lepton1->charge(), weight);
+          h.h_lepton2_pt[i].Fill(lepton2P4.pt(), weight);
+          h.h_lepton2_eta[i].Fill(lepton2->eta(), weight);
+          h.h_lepton2_phi[i].Fill(lepton2->phi(), weight);
+          h.h_lepton2_q[i].Fill(lepton2->charge(), weight);
+          h.h_z_m[i].Fill(z_m, weight);
+          h.h_z_pt[i].Fill(zP4.pt(), weight);
+          h.h_z_eta[i].Fill(zP4.eta(), weight);
+          h.h_z_phi[i].Fill(zP4.phi(), weight);
+          h.h_jets_n[i].Fill(jets_n, weight);
+          h.h_jets_ht[i].Fill(jets_ht, weight);
+          for ( auto jet : *out_jets ) {
+            h.h_jets_pt[i].Fill(jet.pt(), weight);
+            h.h_jets_eta[i].Fill(jet.eta(), weight);
+          }
+          for ( int j=0, n=std::min(jets_n, 4); j<n; ++j ) {
+            const auto& jet = out_jets->at(j);
+            h.h_jet_m[i][j].Fill(jet.mass(), weight);
+            h.h_jet_pt[i][j].Fill(jet.pt(), weight);
+            h.h_jet_eta[i][j].Fill(jet.eta(), weight);
+            h.h_jet_phi[i][j].Fill(jet.phi(), weight);
+            h.h_jet_btag[i][j].Fill(jet.bDiscriminator(bTagIndex_), weight);
+          }
+          h.h_bjets_n[i].Fill(bjets_n, weight);
+          h.h_event_st[i].Fill(leptons_st+jets_ht+met_pt, weight);
         }
-        h.h_bjets_n[i]->Fill(bjets_n, weight);
-        h.h_event_st[i]->Fill(leptons_st+jets_ht+met_pt, weight);
       }
-    }
 
-    // Cutsomized cutflow without z-veto cut to be used in DY estimation and other studies
-    for ( int i=0, nstep=cutstepBits.size(); i<nstep; ++i ) {
-      if ( i != 1 and !cutstepBits[i] ) break; // cutstepBits[1] is zVeto
+      // Cutsomized cutflow without z-veto cut to be used in DY estimation and other studies
+      for ( int i=0, nstep=cutstepBits.size(); i<nstep; ++i ) {
+        if ( i != 1 and !cutstepBits[i] ) break; // cutstepBits[1] is zVeto
 
-      h.h_z_m_noveto[i+3]->Fill(z_m, weight);
-    }
+        h.h_z_m_noveto[i+3].Fill(z_m, weight);
+      }
 
-    // Fill cut flow 2D plot
-    for ( int istep=1, nstep=cutstepBits.size(); istep<=nstep; ++istep ) {
-      const bool res1 = cutstepBits[istep-1];
-
-      // Fill diagonal terms
-      h.h2Cutstep->Fill(istep, istep, res1*weight);
-      h.h2CutstepNoweight->Fill(istep, istep, res1);
-
-      // Fill correlations and anti-correlations
-      for ( int jstep=1; jstep<istep; ++jstep ) {
-        const bool res2 = cutstepBits[jstep-1];
-        const int result = res1 && res2;
-        const int aresult = res1 && !res2;
-        h.h2Cutstep->Fill(istep, jstep, result*weight);
-        h.h2CutstepNoweight->Fill(istep, jstep, result);
-        h.h2Cutstep->Fill(jstep, istep, aresult*weight);
-        h.h2CutstepNoweight->Fill(jstep, istep, aresult);
+      // Fill cut flow 2D plot
+      for ( int istep=1, nstep=cutstepBits.size(); istep<=nstep; ++istep ) {
+        const bool res1 = cutstepBits[istep-1];
+
+        // Fill diagonal terms
+        h.h2Cutstep->Fill(istep, istep, res1*weight);
+        h.h2CutstepNoweight->Fill(istep, istep, res1);
+
+        // Fill correlations and anti-correlations
+        for ( int jstep=1; jstep<istep; ++jstep ) {
+          const bool res2 = cutstepBits[jstep-1];
+          const int result = res1 && res2;
+          const int aresult = res1 && !res2;
+          h.h2Cutstep->Fill(istep, jstep, result*weight);
+          h.h2CutstepNoweight->Fill(istep, jstep, result);
+          h.h2Cutstep->Fill(jstep, istep, aresult*weight);
+          h.h2CutstepNoweight->Fill(jstep, istep, aresult);
+        }
       }
     }
-  }
 
-  event.put(std::auto_ptr<int>(new int(cutstep)), "cutstep");
-  event.put(std::auto_ptr<int>(new int((int)channel)), "channel");
-  event.put(std::auto_ptr<float>(new float(weight)), "weight");
-  event.put(std::auto_ptr<float>(new float(metP4.pt())), "met");
-  event.put(std::auto_ptr<float>(new float(metP4.phi())), "metphi");
-  event.put(out_electrons, "electrons");
-  event.put(out_muons, "muons");
-  event.put(out_jets, "jets");
+    event.put(std::auto_ptr<int>(new int(cutstep)), "cutstep"+var.label);
+    event.put(std::auto_ptr<int>(new int((int)channel)), "channel"+var.label);
+    event.put(std::auto_ptr<float>(new float(weight)), "weight"+var.label);
+    event.put(std::auto_ptr<float>(new float(metP4.pt())), "met"+var.label);
+    event.put(std::auto_ptr<float>(new float(metP4.phi())), "metphi"+var.label);
+    event.put(out_electrons, "electrons"+var.label);
+    event.put(out_muons, "muons"+var.label);
+    event.put(out_jets, "jets"+var.label);
+
+    // Apply filter at the given step. Accept the event if any of the variations passes it,
+    // the cutstep products tell which one did.
+    if ( cutstep >= applyFilterAt_ ) isAccepted = true;
+  }
 
-  // Apply filter at the given step.
-  if ( cutstep >= applyFilterAt_ ) return true;
+  return isAccepted;
+}
 
-  return false;
+void TTLLEventSelector::endJob()
+{
+  booker_.write();
 }
 
 TTLLEventSelector::~TTLLEventSelector()
 {
+  const auto& h_ee = variations_.front().h_ee;
+  const auto& h_mm = variations_.front().h_mm;
+  const auto& h_em = variations_.front().h_em;
   if ( h_em.isBooked ) {
     cout << "---- cut flows without weight ----\n";
     cout << "Step\tee\tmumu\temu\n";
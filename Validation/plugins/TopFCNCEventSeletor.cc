@@ -11,6 +11,7 @@
 
 #include "CATTools/CommonTools/interface/TTbarModeDefs.h"
 #include "CATTools/CommonTools/interface/ScaleFactorEvaluator.h"
+#include "CATTools/CommonTools/interface/ControlPlotBooker.h"
 #include "CATTools/CatAnalyzer/interface/TopTriggerSF.h"
 #include "CATTools/CatAnalyzer/interface/BTagWeightEvaluator.h"
 
@@ -38,10 +39,10 @@ struct ControlPlotsFCNC
     "step8a", "step8b", "step8c", "step9"
   };
 
-  typedef TH1D* H1;
+  typedef cat::ControlPlotBooker::H1 H1;
   typedef TH2D* H2;
 
-  H1 hCutstep, hCutstepNoweight;
+  TH1D* hCutstep, * hCutstepNoweight;
 
   H1 h_vertex_n[nCutstep];
   H1 h_met_pt[nCutstep], h_met_phi[nCutstep];
@@ -60,7 +61,7 @@ struct ControlPlotsFCNC
   H2 h_event_mT_cosDphi[nCutstep];
   H2 h_event_ABCD[nCutstep];
 
-  void book(TFileDirectory&& dir)
+  void book(TFileDirectory&& dir, ControlPlotBooker& booker)
   {
     const double maxeta = 3;
     const double pi = 3.141592;
@@ -80,41 +81,41 @@ struct ControlPlotsFCNC
     }
 
     auto subdir = dir.mkdir(stepNames[0]);
-    h_vertex_n[0] = subdir.make<TH1D>("vertex_n", "vertex_n;Number of primary vertices;Events;Vertex multipliity;Events", 100, 0, 100);
+    h_vertex_n[0] = booker.book(subdir, "vertex", "vertex_n", "vertex_n;Number of primary vertices;Events;Vertex multipliity;Events", 100, 0, 100);
 
     for ( int i=1; i<=3; ++i ) {
       subdir = dir.mkdir(stepNames[i]);
-      h_vertex_n[i] = subdir.make<TH1D>("vertex_n", "vertex_n;Number of primary vertices;Events", 100, 0, 100);
-      h_met_pt[i] = subdir.make<TH1D>("met_pt", "met_pt;Missing transverse momentum (GeV);Events/2GeV", 100, 0, 200);
-      h_met_phi[i] = subdir.make<TH1D>("met_phi", "met_phi;Missing transverse momentum #phi;Events", 100, -pi, pi);
-      h_lepton1_pt[i]  = subdir.make<TH1D>("lepton1_pt", "lepton1_pt;1st leading lepton p_{T} (GeV);Events/2GeV", 100, 0, 200);
-      h_lepton1_eta[i] = subdir.make<TH1D>("lepton1_eta", "lepton1_eta;1st leading lepton #eta;Events", 100, -maxeta, maxeta);
-      h_lepton1_phi[i] = subdir.make<TH1D>("lepton1_phi", "lepton1_phi;1st leading lepton #phi;Events", 100, -pi, pi);
-      h_lepton1_q[i]   = subdir.make<TH1D>("lepton1_q", "lepton1_q;1st leading lepton charge;Events", 3, -1.5, 1.5);
-      h_lepton1_relIso[i]   = subdir.make<TH1D>("lepton1_relIso", "lepton1_relIso;1st leading lepton relative isolation;Events", 100, 0, 1);
-      h_jets_n[i] = subdir.make<TH1D>("jets_n", "jets_n;Jet multiplicity;Events", 10, 0, 10);
-      h_jets_pt[i]  = subdir.make<TH1D>("jets_pt", "jets_pt;Jets p_{T} (GeV);Events/2GeV", 100, 0, 200);
-      h_jets_eta[i] = subdir.make<TH1D>("jets_eta", "jets_eta;Jets #eta;Events", 100, -maxeta, maxeta);
-      h_bjets_n[i] = subdir.make<TH1D>("bjets_n", "bjets_n;b-jet multiplicity;Events", 10, 0, 10);
+      h_vertex_n[i] = booker.book(subdir, "vertex", "vertex_n", "vertex_n;Number of primary vertices;Events", 100, 0, 100);
+      h_met_pt[i] = booker.book(subdir, "met", "met_pt", "met_pt;Missing transverse momentum (GeV);Events/2GeV", 100, 0, 200);
+      h_met_phi[i] = booker.book(subdir, "met", "met_phi", "met_phi;Missing transverse momentum #phi;Events", 100, -pi, pi);
+      h_lepton1_pt[i] = booker.book(subdir, "lepton1", "lepton1_pt", "lepton1_pt;1st leading lepton p_{T} (GeV);Events/2GeV", 100, 0, 200);
+      h_lepton1_eta[i] = booker.book(subdir, "lepton1", "lepton1_eta", "lepton1_eta;1st leading lepton #eta;Events", 100, -maxeta, maxeta);
+      h_lepton1_phi[i] = booker.book(subdir, "lepton1", "lepton1_phi", "lepton1_phi;1st leading lepton #phi;Events", 100, -pi, pi);
+      h_lepton1_q[i] = booker.book(subdir, "lepton1", "lepton1_q", "lepton1_q;1st leading lepton charge;Events", 3, -1.5, 1.5);
+      h_lepton1_relIso[i] = booker.book(subdir, "lepton1", "lepton1_relIso", "lepton1_relIso;1st leading lepton relative isolation;Events", 100, 0, 1);
+      h_jets_n[i] = booker.book(subdir, "jets", "jets_n", "jets_n;Jet multiplicity;Events", 10, 0, 10);
+      h_jets_pt[i] = booker.book(subdir, "jets", "jets_pt", "jets_pt;Jets p_{T} (GeV);Events/2GeV", 100, 0, 200);
+      h_jets_eta[i] = booker.book(subdir, "jets", "jets_eta", "jets_eta;Jets #eta;Events", 100, -maxeta, maxeta);
+      h_bjets_n[i] = booker.book(subdir, "bjets", "bjets_n", "bjets_n;b-jet multiplicity;Events", 10, 0, 10);
     }
 
     for ( int i=4; i<nCutstep; ++i ) {
       subdir = dir.mkdir(stepNames[i]);
-      h_vertex_n[i] = subdir.make<TH1D>("vertex_n", "vertex_n;Number of primary vertices;Events", 100, 0, 100);
-      h_met_pt[i] = subdir.make<TH1D>("met_pt", "met_pt;Missing transverse momentum (GeV);Events/2GeV", 100, 0, 200);
-      h_met_phi[i] = subdir.make<TH1D>("met_phi", "met_phi;Missing transverse momentum #phi;Events", 100, -pi, pi);
+      h_vertex_n[i] = booker.book(subdir, "vertex", "vertex_n", "vertex_n;Number of primary vertices;Events", 100, 0, 100);
+      h_met_pt[i] = booker.book(subdir, "met", "met_pt", "met_pt;Missing transverse momentum (GeV);Events/2GeV", 100, 0, 200);
+      h_met_phi[i] = booker.book(subdir, "met", "met_phi", "met_phi;Missing transverse momentum #phi;Events", 100, -pi, pi);
 
-      h_lepton1_pt[i]  = subdir.make<TH1D>("lepton1_pt", "lepton1_pt;1st leading lepton p_{T} (GeV);Events/2GeV", 100, 0, 200);
-      h_lepton1_eta[i] = subdir.make<TH1D>("lepton1_eta", "lepton1_eta;1st leading lepton #eta;Events", 100, -maxeta, maxeta);
-      h_lepton1_phi[i] = subdir.make<TH1D>("lepton1_phi", "lepton1_phi;1st leading lepton #phi;Events", 100, -pi, pi);
-      h_lepton1_q[i]   = subdir.make<TH1D>("lepton1_q", "lepton1_q;1st leading lepton charge;Events", 3, -1.5, 1.5);
-      h_lepton1_relIso[i]   = subdir.make<TH1D>("lepton1_relIso", "lepton1_relIso;1st leading lepton relative isolation;Events", 100, 0, 1);
+      h_lepton1_pt[i] = booker.book(subdir, "lepton1", "lepton1_pt", "lepton1_pt;1st leading lepton p_{T} (GeV);Events/2GeV", 100, 0, 200);
+      h_lepton1_eta[i] = booker.book(subdir, "lepton1", "lepton1_eta", "lepton1_eta;1st leading lepton #eta;Events", 100, -maxeta, maxeta);
+      h_lepton1_phi[i] = booker.book(subdir, "lepton1", "lepton1_phi", "lepton1_phi;1st leading lepton #phi;Events", 100, -pi, pi);
+      h_lepton1_q[i] = booker.book(subdir, "lepton1", "lepton1_q", "lepton1_q;1st leading lepton charge;Events", 3, -1.5, 1.5);
+      h_lepton1_relIso[i] = booker.book(subdir, "lepton1", "lepton1_relIso", "lepton1_relIso;1st leading lepton relative isolation;Events", 100, 0, 1);
 
-      h_jets_n[i] = subdir.make<TH1D>("jets_n", "jets_n;Jet multiplicity;Events", 10, 0, 10);
-      h_jets_pt[i]  = subdir.make<TH1D>("jets_pt", "jets_pt;Jets p_{T} (GeV);Events/2GeV", 100, 0, 200);
-      h_jets_eta[i] = subdir.make<TH1D>("jets_eta", "jets_eta;Jets #eta;Events", 100, -maxeta, maxeta);
+      h_jets_n[i] = booker.book(subdir, "jets", "jets_n", "jets_n;Jet multiplicity;Events", 10, 0, 10);
+      h_jets_pt[i] = booker.book(subdir, "jets", "jets_pt", "jets_pt;Jets p_{T} (GeV);Events/2GeV", 100, 0, 200);
+      h_jets_eta[i] = booker.book(subdir, "jets", "jets_eta", "jets_eta;Jets #eta;Events", 100, -maxeta, maxeta);
 
-      h_event_mT[i] = subdir.make<TH1D>("event_mT", "transverse mass;Transverse mass (GeV);Events/2GeV", 100, 0, 200);
+      h_event_mT[i] = booker.book(subdir, "event", "event_mT", "transverse mass;Transverse mass (GeV);Events/2GeV", 100, 0, 200);
       h_event_mT_cosDphi[i] = subdir.make<TH2D>("event_mT_cosDphi", "transverse mass vs #delta#phi;Transverse mass (GeV);cos(#Delta#phi(lepton,MET));Events/2GeV", 100, 0, 200,100,0,1);
       h_event_ABCD[i] = subdir.make<TH2D>("event_ABCD", "ABCD;isIso;isQCDLike;Events", 2, 0, 2, 2, 0, 2);
 
@@ -125,14 +126,14 @@ struct ControlPlotsFCNC
         else if ( j == 1 ) titlePrefix = "2nd";
         else if ( j == 2 ) titlePrefix = "3rd";
         else titlePrefix = Form("%dth", j+1);
-        h_jet_m  [i][j] = subdir.make<TH1D>((prefix+"m").c_str(), (prefix+"m;"+titlePrefix+" leading jet mass (GeV);Events/2GeV").c_str(), 100, 0, 200);
-        h_jet_pt [i][j] = subdir.make<TH1D>((prefix+"pt").c_str(), (prefix+"pt;"+titlePrefix+" leading jet p_{T} (GeV);Events/2GeV").c_str(), 100, 0, 200);
-        h_jet_eta[i][j] = subdir.make<TH1D>((prefix+"eta").c_str(), (prefix+"eta;"+titlePrefix+" leading jet #eta;Events").c_str(), 100, -maxeta, maxeta);
-        h_jet_phi[i][j] = subdir.make<TH1D>((prefix+"phi").c_str(), (prefix+"phi;"+titlePrefix+" leading jet #phi;Events").c_str(), 100, -pi, pi);
-        h_jet_btag[i][j] = subdir.make<TH1D>((prefix+"btag").c_str(), (prefix+"btag;"+titlePrefix+" leading jet b discriminator output;Events").c_str(), 100, 0, 1);
+        h_jet_m  [i][j] = booker.book(subdir, "jet", (prefix+"m"), (prefix+"m;"+titlePrefix+" leading jet mass (GeV);Events/2GeV"), 100, 0, 200);
+        h_jet_pt [i][j] = booker.book(subdir, "jet", (prefix+"pt"), (prefix+"pt;"+titlePrefix+" leading jet p_{T} (GeV);Events/2GeV"), 100, 0, 200);
+        h_jet_eta[i][j] = booker.book(subdir, "jet", (prefix+"eta"), (prefix+"eta;"+titlePrefix+" leading jet #eta;Events"), 100, -maxeta, maxeta);
+        h_jet_phi[i][j] = booker.book(subdir, "jet", (prefix+"phi"), (prefix+"phi;"+titlePrefix+" leading jet #phi;Events"), 100, -pi, pi);
+        h_jet_btag[i][j] = booker.book(subdir, "jet", (prefix+"btag"), (prefix+"btag;"+titlePrefix+" leading jet b discriminator output;Events"), 100, 0, 1);
       }
 
-      h_bjets_n[i] = subdir.make<TH1D>("bjets_n", "bjets_n;b-jet multiplicity;Events", 10, 0, 10);
+      h_bjets_n[i] = booker.book(subdir, "bjets", "bjets_n", "bjets_n;b-jet multiplicity;Events", 10, 0, 10);
 
     }
   };
@@ -145,6 +146,7 @@ class TopFCNCEventSelector : public edm::one::EDFilter<edm::one::SharedResources
 public:
   TopFCNCEventSelector(const edm::ParameterSet& pset);
   bool filter(edm::Event& event, const edm::EventSetup&) override;
+  void endJob() override;
   ~TopFCNCEventSelector();
 
 private:
@@ -204,7 +206,7 @@ private:
     if ( std::abs(el.eta()) > 2.5 ) return false;
     if ( std::isnan(el.pt()) or el.pt() < 30 ) return false;
 
-    if ( !el.electronID(elIdName_) ) return false;
+    if ( !el.electronID(elIdIndex_) ) return false;
     const double scEta = std::abs(el.scEta());
     if ( isEcalCrackVeto_ and scEta > 1.4442 and scEta < 1.566 ) return false;
     const double d0 = std::abs(el.dxy()), dz = std::abs(el.dz());
@@ -213,7 +215,7 @@ private:
     return true;
   }
   bool isIsoLepton(const cat::Muon& mu) const { return mu.relIso(0.4) < 0.15; }
-  bool isIsoLepton(const cat::Electron& el) const { return el.electronID(elIsoIdName_); }
+  bool isIsoLepton(const cat::Electron& el) const { return el.electronID(elIsoIdIndex_); }
   bool isVetoMuon(const cat::Muon& mu)
   {
     if ( std::abs(mu.eta()) > 2.4 ) return false;
@@ -227,7 +229,7 @@ private:
   {
     if ( std::abs(el.eta()) > 2.5 ) return false;
     if ( std::isnan(el.pt()) or el.pt() < 10 ) return false;
-    if ( !el.electronID(elVetoIdName_) ) return false;
+    if ( !el.electronID(elVetoIdIndex_) ) return false;
     const double scEta = std::abs(el.scEta());
     const double d0 = std::abs(el.dxy()), dz = std::abs(el.dz());
     if      ( scEta <= 1.479 and (d0 > 0.05 or dz > 0.1) ) return false;
@@ -237,7 +239,7 @@ private:
   bool isBjet(const cat::Jet& jet)
   {
     using namespace cat;
-    const double bTag = jet.bDiscriminator(bTagName_);
+    const double bTag = jet.bDiscriminator(bTagIndex_);
     if      ( bTagWP_ == BTagWP::CSVL ) return bTag > WP_BTAG_CSVv2L;
     else if ( bTagWP_ == BTagWP::CSVM ) return bTag > WP_BTAG_CSVv2M;
     else if ( bTagWP_ == BTagWP::CSVT ) return bTag > WP_BTAG_CSVv2T;
@@ -266,7 +268,9 @@ private:
   bool isMuonAntiIso_, isElectronAntiIso_;
   bool isSkipEleSmearing_; // Do not apply energy smearing, needed to remove randomness during the synchronization
   std::string bTagName_;
+  int bTagIndex_; // Position of bTagName_ in the jet discriminator list, resolved per event
   std::string elIdName_, elIsoIdName_, elVetoIdName_;
+  int elIdIndex_, elIsoIdIndex_, elVetoIdIndex_; // Positions in the electron ID list, resolved per event
   enum class BTagWP { CSVL, CSVM, CSVT } bTagWP_;
 
   BTagWeightEvaluator bTagWeight_;
@@ -274,6 +278,7 @@ private:
 
 private:
   ControlPlotsFCNC h_ch;
+  ControlPlotBooker booker_;
 
   std::ofstream eventListFile_;
 
@@ -314,6 +319,7 @@ TopFCNCEventSelector::TopFCNCEventSelector(const edm::ParameterSet& pset):
   elIdName_ = electronSet.getParameter<string>("idName");
   elIsoIdName_ = electronSet.getParameter<string>("isoIdName");
   elVetoIdName_ = electronSet.getParameter<string>("vetoIdName");
+  elIdIndex_ = elIsoIdIndex_ = elVetoIdIndex_ = -1;
   electronScale_ = electronSet.getParameter<int>("scaleDirection");
   if ( isMC_ ) {
     const auto electronSFSet = electronSet.getParameter<edm::ParameterSet>("efficiencySF");
@@ -389,7 +395,10 @@ TopFCNCEventSelector::TopFCNCEventSelector(const edm::ParameterSet& pset):
   usesResource("TFileService");
   edm::Service<TFileService> fs;
   const string channelStr = channel_ == 11 ? "el" : "mu";
-  h_ch.book(fs->mkdir(channelStr));
+  if ( pset.existsAs<std::vector<std::string> >("disabledHistogramGroups") ) {
+    booker_.setDisabledGroups(pset.getParameter<std::vector<std::string> >("disabledHistogramGroups"));
+  }
+  h_ch.book(fs->mkdir(channelStr), booker_);
 
   produces<int>("cutstep");
   produces<int>("channel");
@@ -491,6 +500,11 @@ bool TopFCNCEventSelector::filter(edm::Event& event, const edm::EventSetup&)
     if ( isVetoMuon(lep) ) vetoMuons.push_back(lep);
   }
   cat::ElectronCollection selElectrons, vetoElectrons;
+  if ( !electronHandle->empty() ) {
+    elIdIndex_ = electronHandle->at(0).checkedElectronIDIndex(elIdName_);
+    elIsoIdIndex_ = electronHandle->at(0).checkedElectronIDIndex(elIsoIdName_);
+    elVetoIdIndex_ = electronHandle->at(0).checkedElectronIDIndex(elVetoIdName_);
+  }
   for ( int i=0, n=electronHandle->size(); i<n; ++i ) {
     auto& p = electronHandle->at(i);
     const double scale = shiftedElectronScale(p)/(isSkipEleSmearing_ ? p.smearedScale() : 1);
@@ -556,6 +570,7 @@ bool TopFCNCEventSelector::filter(edm::Event& event, const edm::EventSetup&)
 
   // Select good jets
   int bjets_n = 0;
+  bTagIndex_ = jetHandle->empty() ? -1 : jetHandle->at(0).bDiscriminatorIndex(bTagName_);
   for ( int i=0, n=jetHandle->size(); i<n; ++i ) {
     auto& p = jetHandle->at(i);
     if ( std::abs(p.eta()) > 2.4 ) continue;
@@ -622,36 +637,36 @@ bool TopFCNCEventSelector::filter(edm::Event& event, const edm::EventSetup&)
     h_ch.hCutstep->Fill(cutstep, w);
     h_ch.hCutstepNoweight->Fill(cutstep);
 
-    h_ch.h_vertex_n[cutstep]->Fill(nGoodVertex, w);
+    h_ch.h_vertex_n[cutstep].Fill(nGoodVertex, w);
     if ( cutstep >= 1 ) {
-      h_ch.h_met_pt[cutstep]->Fill(met_pt, w);
-      h_ch.h_met_phi[cutstep]->Fill(met_phi, w);
+      h_ch.h_met_pt[cutstep].Fill(met_pt, w);
+      h_ch.h_met_phi[cutstep].Fill(met_phi, w);
 
       if ( lepton1 ) {
-        h_ch.h_lepton1_pt[cutstep]->Fill(lepton1->pt(), w);
-        h_ch.h_lepton1_eta[cutstep]->Fill(lepton1->eta(), w);
-        h_ch.h_lepton1_phi[cutstep]->Fill(lepton1->phi(), w);
-        h_ch.h_lepton1_q[cutstep]->Fill(lepton1->charge(), w);
-        h_ch.h_lepton1_relIso[cutstep]->Fill(lepton1_relIso, w);
+        h_ch.h_lepton1_pt[cutstep].Fill(lepton1->pt(), w);
+        h_ch.h_lepton1_eta[cutstep].Fill(lepton1->eta(), w);
+        h_ch.h_lepton1_phi[cutstep].Fill(lepton1->phi(), w);
+        h_ch.h_lepton1_q[cutstep].Fill(lepton1->charge(), w);
+        h_ch.h_lepton1_relIso[cutstep].Fill(lepton1_relIso, w);
       }
 
-      h_ch.h_jets_n[cutstep]->Fill(jets_n, w);
+      h_ch.h_jets_n[cutstep].Fill(jets_n, w);
       for ( int j=0, n=std::min(6, jets_n); j<n; ++j ) {
-        h_ch.h_jets_pt[cutstep]->Fill(out_jets->at(j).pt(), w);
-        h_ch.h_jets_eta[cutstep]->Fill(out_jets->at(j).eta(), w);
+        h_ch.h_jets_pt[cutstep].Fill(out_jets->at(j).pt(), w);
+        h_ch.h_jets_eta[cutstep].Fill(out_jets->at(j).eta(), w);
       }
-      h_ch.h_bjets_n[cutstep]->Fill(bjets_n, w);
+      h_ch.h_bjets_n[cutstep].Fill(bjets_n, w);
     }
     if ( cutstep >= 4 ) {
       const bool isQCDLike = mT < 10 and cosDphi < cos(1.0) and met_pt < 10;
       for ( int j=0, n=std::min(6, jets_n); j<n; ++j ) {
-        h_ch.h_jet_m  [cutstep][j]->Fill(out_jets->at(j).mass(), w);
-        h_ch.h_jet_pt [cutstep][j]->Fill(out_jets->at(j).pt(), w);
-        h_ch.h_jet_eta[cutstep][j]->Fill(out_jets->at(j).eta(), w);
-        h_ch.h_jet_phi[cutstep][j]->Fill(out_jets->at(j).phi(), w);
-        h_ch.h_jet_btag[cutstep][j]->Fill(out_jets->at(j).bDiscriminator(bTagName_), w);
+        h_ch.h_jet_m  [cutstep][j].Fill(out_jets->at(j).mass(), w);
+        h_ch.h_jet_pt [cutstep][j].Fill(out_jets->at(j).pt(), w);
+        h_ch.h_jet_eta[cutstep][j].Fill(out_jets->at(j).eta(), w);
+        h_ch.h_jet_phi[cutstep][j].Fill(out_jets->at(j).phi(), w);
+        h_ch.h_jet_btag[cutstep][j].Fill(out_jets->at(j).bDiscriminator(bTagIndex_), w);
 
-        h_ch.h_event_mT[cutstep]->Fill(mT, w);
+        h_ch.h_event_mT[cutstep].Fill(mT, w);
         h_ch.h_event_mT_cosDphi[cutstep]->Fill(mT, cosDphi, w);
         h_ch.h_event_ABCD[cutstep]->Fill(lepton1_isIso, isQCDLike, w);
       }
@@ -706,6 +721,11 @@ bool TopFCNCEventSelector::filter(edm::Event& event, const edm::EventSetup&)
   return true;
 }
 
+void TopFCNCEventSelector::endJob()
+{
+  booker_.write();
+}
+
 TopFCNCEventSelector::~TopFCNCEventSelector()
 {
   if ( h_ch.hCutstepNoweight ) {
@@ -8,6 +8,9 @@ eventsFCNC = cms.EDFilter("TopFCNCEventSelector",
     ## alwaysAcceptAfter : Accept event even though selection may fail _AFTER_ this step
     ## Use case: store ntuple only for events that passes step4
     applyFilterAt = cms.int32(9), ## 9 is nJet3
+    ## Groups of control plots not to be filled, among
+    ## vertex, met, lepton1, jets, jet, bjets, event
+    disabledHistogramGroups = cms.vstring(),
 
     # Physics objects
     muon = cms.PSet(
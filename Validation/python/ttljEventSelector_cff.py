@@ -8,6 +8,9 @@ eventsTTLJ = cms.EDFilter("TTLJEventSelector",
     ## Use case: store ntuple only for events that passes step4
     applyFilterAt = cms.int32(8), ## 8 for nJet4
     skipHistograms = cms.bool(False),
+    ## Groups of control plots not to be filled, among
+    ## vertex, met, leptons, lepton1, lepton2, z, jets, jet, bjets, event
+    disabledHistogramGroups = cms.vstring(),
 
     # Physics objects
     muon = cms.PSet(
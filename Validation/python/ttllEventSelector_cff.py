@@ -8,6 +8,9 @@ eventsTTLL = cms.EDFilter("TTLLEventSelector",
     ## Use case: store ntuple only for events that passes step4
     applyFilterAt = cms.int32(4), ## index start from negative. step 4 for MET cut
     skipHistograms = cms.bool(False),
+    ## Groups of control plots not to be filled, among
+    ## vertex, met, leptons, lepton1, lepton2, z, jets, jet, bjets, event
+    disabledHistogramGroups = cms.vstring(),
 
     # Physics objects
     muon = cms.PSet(
@@ -73,5 +76,20 @@ eventsTTLL = cms.EDFilter("TTLLEventSelector",
         src = cms.InputTag("flatGenWeights"),
     ),
     extWeights = cms.VInputTag(),
+
+    # Energy scale variations evaluated in the same module instance.
+    # Products of each variation carry its label as a suffix of the instance names,
+    # e.g. "eventsTTLL:cutstepJESUp", and histograms go to the subdirectory with the label.
+    # Directions which are not given are taken from the nominal setting above.
+    variations = cms.VPSet(
+        #cms.PSet(label = cms.string("JESUp"), jetScale = cms.int32(+1)),
+        #cms.PSet(label = cms.string("JESDn"), jetScale = cms.int32(-1)),
+        #cms.PSet(label = cms.string("JERUp"), jetResol = cms.int32(+1)),
+        #cms.PSet(label = cms.string("JERDn"), jetResol = cms.int32(-1)),
+        #cms.PSet(label = cms.string("MuonUp"), muonScale = cms.int32(+1)),
+        #cms.PSet(label = cms.string("MuonDn"), muonScale = cms.int32(-1)),
+        #cms.PSet(label = cms.string("ElectronUp"), electronScale = cms.int32(+1)),
+        #cms.PSet(label = cms.string("ElectronDn"), electronScale = cms.int32(-1)),
+    ),
 )
 